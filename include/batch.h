@@ -0,0 +1,78 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include "engine.h"
+
+/*
+    Actions of a single step of a game in a batch or an environment.
+*/
+enum Action {
+    ACTION_NONE,
+    ACTION_LEFT,
+    ACTION_RIGHT,
+    ACTION_ROTATE_RIGHT,    // clockwise
+    ACTION_ROTATE_LEFT,     // counter-clockwise
+    ACTION_SOFT_DROP,       // one row down, locks the piece if it can't move
+    ACTION_HARD_DROP,
+    ACTIONS,
+};
+
+/*
+    Many games stepped together, stored as a struct of arrays: element i of every array belongs to game i.
+    Only the state needed for playing is kept, the bitboard of every game but no color plane or board features,
+    so thousands of games fit into the cache and every step walks the arrays front to back.
+
+    The arrays point into memory provided to init_batch, the batch never allocates.
+    The rules follow the same engine logic as move, rotate_piece, drop and hard_drop on a GameData.
+    verify_batch (see verify.h) plays both side by side and compares them after every step.
+*/
+struct BatchGames {
+    int count;
+    int width;                      // dimensions of the arenas of all games
+    int height;
+    int gravity_steps;              // pieces fall by one row every gravity_steps steps, 0 disables gravity (default 1)
+
+    enum RuleSetType rule_set;
+    struct RuleSet rules;
+    struct GameConfig config;       // used whenever a game is reset
+    uint32_t seed;
+
+    arena_row_t* rows;              // the height rows of game i start at rows[i * height]
+    uint8_t* piece;                 // enum Piece of the current piece
+    uint8_t* rotation;
+    int8_t* position_x;
+    int8_t* position_y;
+    uint16_t* gravity_timer;        // steps since the piece last fell
+    uint32_t* score;
+    uint32_t* cleared_lines;
+    uint32_t* level;
+    uint32_t* episode;              // number of times the game was reset, it is part of the seed of the game
+    struct Rng* rng;
+    struct Randomizer* randomizer;
+    struct PieceQueue* preview;
+};
+
+/*
+    Returns the number of bytes of memory init_batch needs for count games with the given config.
+*/
+size_t batch_memory_size(int count, const struct GameConfig* config);
+
+/*
+    Sets up count games in the given memory, which has to hold batch_memory_size bytes and be aligned to CACHE_LINE_SIZE.
+    Game i is seeded from seed, i and the number of its resets, so a batch always plays the same games for the same seed.
+*/
+void init_batch(struct BatchGames* batch, void* memory, int count, uint32_t seed, const struct GameConfig* config);
+
+/*
+    Starts a new episode of game i.
+*/
+void batch_reset_game(struct BatchGames* batch, int game);
+
+/*
+    Applies actions[i] (enum Action) to game i for every game of the batch, followed by gravity.
+    rewards[i] receives the points game i scored in this step and dones[i] is set to 1 when the game was lost.
+    Lost games are reset right away, so the next step starts their next episode.
+*/
+void batch_step(struct BatchGames* batch, const uint8_t* actions, float* rewards, uint8_t* dones);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef BEAM_SEARCH_H_
+#define BEAM_SEARCH_H_
+
+#include "engine.h"
+#include "evaluator.h"
+#include "movegen.h"
+#include "thread_pool.h"
+#include "undo.h"
+
+struct BeamConfig {
+    int beam_width;             // positions kept after every piece (default 64)
+    int depth;                  // pieces placed ahead, limited to the current and the preview pieces, 0 uses all of them
+    int threads;                // threads of the search including the caller, 0 uses one per processor
+    double time_budget;         // seconds per search, 0 has no limit; the search stops after the piece it is at
+    float weights[EVAL_FEATURES];   // weights of the evaluator (default EL_TETRIS_WEIGHTS)
+};
+
+/*
+    A position in the beam: a game after some placements and the rating of the path to it.
+*/
+struct BeamNode {
+    struct GameData game_data;
+    float score;                // sum of the ratings of all boards on the path
+    int root;                   // index of the first placement of the path in the placements of the searched game
+};
+
+/*
+    A child that might enter the next beam, it is only played once it was selected.
+*/
+struct BeamCandidate {
+    float score;
+    int parent;                 // index of the node in the beam
+    int placement;              // index of the placement in the placements of the parent
+};
+
+/*
+    Scratch memory of a thread, allocated once so that the search itself never allocates.
+*/
+struct BeamThread {
+    struct PlacementRatings ratings;    // the placements of a parent and the ratings of its children
+
+    struct BeamCandidate* best;         // the best beam_width children the thread found, as a heap with the worst on top
+    int best_count;
+    int list_parent;                    // parent the list was generated for while playing the selected children, -1 for none
+};
+
+/*
+    Bot that places pieces by a beam search over the placements of the current and the preview pieces.
+    Every step expands all positions of the beam with every placement, rates the resulting boards with
+    the evaluator and keeps the best beam_width of them. The expansion is spread across a thread pool.
+    Only the children that enter the next beam are played through the engine.
+
+    The result doesn't depend on the number of threads.
+*/
+struct BeamSearch {
+    struct BeamConfig config;
+    struct Evaluator evaluator;
+    struct ThreadPool pool;
+
+    struct PlacementList* root_list;    // placements of the searched game, the result indexes them
+    struct BeamNode* beam;              // the current beam and the next one, beam_width nodes each
+    struct BeamNode* next_beam;
+    int beam_count;
+    struct BeamCandidate* candidates;   // the children of all threads, beam_width per thread
+    int candidate_count;
+    struct BeamThread* threads;
+    int depth;                          // piece of the path that is placed by the current step, 0 is the current piece
+
+    int depth_reached;                  // pieces the last search got through
+    uint64_t nodes;                     // children rated by the last search
+};
+
+struct BeamConfig default_beam_config(void);
+
+/*
+    Allocates the memory and the threads of the search. Returns false when the memory can't be allocated.
+    Threads that can't be started are left out: the search then runs on fewer threads and config.threads holds their number.
+    The search keeps pointers into itself, it must not be moved after init_beam_search.
+*/
+bool init_beam_search(struct BeamSearch* search, const struct BeamConfig* config);
+
+void destroy_beam_search(struct BeamSearch* search);
+
+/*
+    Searches the best placement of the current piece of the game. Returns its index in search->root_list
+    or -1 when the piece has no placement.
+*/
+int beam_search_best(struct BeamSearch* search, const struct GameData* game_data);
+
+/*
+    Searches the best placement and plays it with play_placement. Returns false when there is none.
+*/
+bool beam_search_play(struct BeamSearch* search, struct GameData* game_data);
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "pieces.h"
+
+// the standard arena, code for it is specialized at compile time
+#define ARENA_WIDTH  10
+#define ARENA_HEIGHT 20
+
+// limits for arenas with runtime dimensions
+#define ARENA_MIN_WIDTH  4                  // the I piece has to fit
+#define ARENA_MIN_HEIGHT 4
+#define ARENA_MAX_WIDTH  64                 // a row is a single 64 bit word
+#define ARENA_MAX_HEIGHT 32                 // a column is a single 32 bit word
+
+/*
+    A row of the arena bitboard, bit x is set when the cell in column x is occupied.
+*/
+typedef uint64_t arena_row_t;
+
+/*
+    The helpers below are forced inline so that calls with the constant dimensions of the standard arena
+    are specialized by the compiler, while the same code handles any other size at runtime.
+*/
+#define BOARD_INLINE static inline __attribute__((always_inline))
+
+/*
+    The helpers with the suffix _sized take the dimensions of the arena as their last parameters.
+    WITH_ARENA_SIZE calls them with constant dimensions for the standard arena, so the compiler emits
+    a specialized copy for 10 x 20 next to the generic one for every other size.
+    board can be anything with the fields width and height, like a game.
+*/
+#define IS_STANDARD_ARENA(board) ((board)->width == ARENA_WIDTH && (board)->height == ARENA_HEIGHT)
+#define WITH_ARENA_SIZE(board, function, ...) \
+    (IS_STANDARD_ARENA(board) ? function(__VA_ARGS__, ARENA_WIDTH, ARENA_HEIGHT) \
+                              : function(__VA_ARGS__, (board)->width, (board)->height))
+
+/*
+    Returns the mask of a completely filled row of an arena with the given width.
+*/
+BOARD_INLINE arena_row_t full_row_mask(int width)
+{
+    return (width >= 64) ? ~(arena_row_t)0 : (((arena_row_t)1 << width) - 1);
+}
+
+/*
+    Shifts a row mask of a piece matrix to the column position_x of the arena.
+    The caller has to make sure that no block of the row ends up outside of the arena.
+*/
+BOARD_INLINE arena_row_t shift_piece_row(uint16_t mask, int position_x)
+{
+    return (position_x < 0) ? (arena_row_t)mask >> -position_x : (arena_row_t)mask << position_x;
+}
+
+/*
+    Checks if the blocks of the piece lie between the side walls of the arena.
+*/
+BOARD_INLINE bool board_piece_inside_walls(const struct PieceShape* shape, int position_x, int width)
+{
+    return position_x + shape->min_x >= 0 && position_x + shape->max_x < width;
+}
+
+/*
+    Checks if the given piece overlaps the walls, the floor or any occupied cell of the rows.
+    Rows above the arena are treated as empty.
+*/
+BOARD_INLINE bool board_piece_collides(const arena_row_t* rows, int width, int height,
+                                       enum Piece piece, int rotation, int position_x, int position_y)
+{
+    const struct PieceShape* shape = get_piece_shape(piece, rotation);
+
+    if (!board_piece_inside_walls(shape, position_x, width)) return true;
+    if (position_y + shape->max_y >= height) return true;
+
+    for (int y = shape->min_y; y <= shape->max_y; y++) {
+        int row = position_y + y;
+        if (row >= 0 && (rows[row] & shift_piece_row(shape->row_masks[y], position_x)) != 0) return true;
+    }
+    return false;
+}
+
+#endif
@@ -4,31 +4,40 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdalign.h>
 #include <time.h>
 #include <memory.h>
 #include <stdio.h>
 #include <errno.h>
 #include <math.h>
 
+#include "board.h"
 #include "helper.h"
+#include "pieces.h"
+#include "randomizer.h"
+#include "rng.h"
+#include "rotation.h"
+#include "rules.h"
+#include "zobrist.h"
 
-#define ARENA_WIDTH  10
-#define ARENA_HEIGHT 20
+// bitmask of a completely filled row of the standard arena (one bit per column)
+#define ARENA_ROW_FULL ((arena_row_t)((1u << ARENA_WIDTH) - 1))
 
-#define START_POSITION_X 4
+// GameData is aligned to this so that copies of it never straddle more cache lines than needed
+#define CACHE_LINE_SIZE 64
+
+// the top rows of the arena in which new pieces spawn
+#define SPAWN_ZONE_ROWS 2
+#define SPAWN_ZONE_MASK ((1u << SPAWN_ZONE_ROWS) - 1)
+
+// column in which new pieces spawn, 4 for the standard arena
+#define START_POSITION_X(width) ((width) / 2 - 1)
 #define START_POSITION_Y 0
 
-#define FAST_DROP_TIME 0.05
 #define MOVE_SIDE_WAYS_TIME 0.2
+#define MOVE_SIDE_WAYS_TICKS SECONDS_TO_TICKS(MOVE_SIDE_WAYS_TIME)
 
-#ifdef DEBUG
-    #define BASE_TIME .2
-#else
-    #define BASE_TIME   1.0
-#endif
-#define TIME_OFFSET .285
-
-#define COORDS_TO_ARENA_INDEX(x, y) (coords_to_array_index((x), (y), ARENA_WIDTH))
+#define COORDS_TO_ARENA_INDEX(game_data, x, y) (coords_to_array_index((x), (y), (game_data)->width))
 
 enum GameState {
     PAUSE,      // Game paused while in menu
@@ -36,12 +45,82 @@ enum GameState {
     GAME_OVER   // After losing the game, this gamestate is reached
 };
 
-struct GameData {
-    enum GameState gameState;
+/*
+    Features of the arena that are kept up to date whenever a piece is locked or rows are cleared,
+    so evaluators can read them instead of scanning the arena.
+    Wells count the walls as columns of full height.
+*/
+struct BoardFeatures {
+    uint32_t column_masks[ARENA_MAX_WIDTH];     // occupancy of every column, bit 0 is the bottom row
+    uint8_t column_heights[ARENA_MAX_WIDTH];    // number of rows from the floor up to the top most block of every column
+    uint8_t column_holes[ARENA_MAX_WIDTH];      // empty cells below the top most block of every column
+    uint8_t well_depths[ARENA_MAX_WIDTH];       // how many rows a column lies below the lower of its two neighbours
+    uint8_t row_fill[ARENA_MAX_HEIGHT];         // number of blocks in every row
+
+    uint16_t aggregate_height;              // sum of the column heights
+    uint16_t max_height;
+    uint16_t holes;                         // sum of the column holes
+    uint16_t bumpiness;                     // sum of the height differences of neighbouring columns
+    uint16_t wells;                         // sum of the well depths
+};
 
-    int* current_piece;             // current piece, no fixed size
-    int* next_piece;                // save the next piece for the display
-    int* arena;                     // width: 10, height: 20 -> 200 uints
+/*
+    Timers of the fixed step simulation, advanced by game_tick (see tick.h).
+    They count whole ticks, so the game behaves the same at any frame rate.
+*/
+struct TickState {
+    uint32_t tick;                  // number of ticks simulated since the game started
+    uint32_t gravity_fraction;      // part of a cell gravity has moved the piece so far, in units of GRAVITY_ONE
+    uint32_t side_timer;            // ticks the current side button has been held
+    uint32_t lock_timer;            // ticks the current piece has been resting on the ground
+    uint32_t lock_resets;           // number of times the lock delay of the current piece was restarted
+    unsigned held_inputs;           // side and soft drop flags of enum Input held during the previous tick
+};
+
+/*
+    How the game reacts to held buttons, in ticks of the fixed step simulation.
+*/
+struct Handling {
+    uint16_t das;                   // delayed auto shift: ticks a side button is held before the move repeats
+    uint16_t arr;                   // auto repeat rate: ticks between repeated moves, 0 moves to the wall at once
+    uint16_t soft_drop_factor;      // gravity is this many times faster while soft drop is held
+    uint16_t lock_delay;            // ticks a piece rests on the ground before it locks, 0 locks with the next gravity step
+    uint16_t lock_resets;           // moves and rotations on the ground that restart the lock delay, per piece
+};
+
+/*
+    Settings that are chosen once when a game is created.
+*/
+struct GameConfig {
+    enum RandomizerType randomizer;     // how the upcoming pieces are drawn
+    int preview_depth;                  // number of upcoming pieces kept in the preview queue (1 - PREVIEW_MAX_DEPTH)
+    enum RotationSystem rotation_system; // which wall kicks are tried when rotating
+    unsigned defeat_rules;              // combination of enum DefeatRule flags
+    int width;                          // dimensions of the arena, clamped to ARENA_MIN_* and ARENA_MAX_*
+    int height;
+    struct Handling handling;           // DAS, ARR, soft drop and lock delay
+    enum RuleSetType rule_set;          // scoring, levels and speed
+    const struct RuleSet* custom_rules; // the rules used with RULES_CUSTOM, copied into the game
+};
+
+/*
+    The complete state of one game. All arrays are embedded, so an instance can be copied with memcpy,
+    allocated on the stack or kept in a pool without owning any heap memory.
+    The arrays are sized for the largest arena, only the first width columns and height rows are used.
+*/
+struct GameData {
+    alignas(CACHE_LINE_SIZE) enum GameState gameState;
+
+    enum Piece current_piece;       // type of the current piece
+    int rotation;                   // orientation of the current piece, number of clockwise rotations (0-3)
+    struct PieceQueue preview;      // upcoming pieces, the first one is shown in the display
+    int width;                      // dimensions of the arena, 10 x 20 for the standard game
+    int height;
+    uint8_t arena[ARENA_MAX_WIDTH * ARENA_MAX_HEIGHT];  // color plane, only used for rendering: row after row with width ids
+    arena_row_t arena_rows[ARENA_MAX_HEIGHT];   // bitboard of the arena: bit x of row y is set when the cell is occupied
+    struct BoardFeatures features;  // read through get_board_features
+    uint64_t arena_hash;            // zobrist hash of the occupied cells of the arena
+    uint64_t hash;                  // arena_hash combined with the key of the current piece, rotation and position
 
     int position_x;                 // position of the current piece inside the arena
     int position_y;
@@ -53,33 +132,31 @@ struct GameData {
     uint32_t level;                 // level for piece velocity
     uint32_t cleared_lines;
 
-    int* piece_count;               // saves the number of times the piece have shown up
+    int piece_count[PIECE_TYPES];   // saves the number of times the piece have shown up
 
     double accumulated_time;        // current playing time
+    struct TickState ticks;         // timers of the fixed step simulation
+    struct Handling handling;
+    enum RuleSetType rule_set;
+    struct RuleSet rules;           // copy of the rules of the game, the engine uses the constants of the built-in ones
 
     bool is_defeat;                 // detemins wheter the player has lost
+    unsigned defeat_rules;          // combination of enum DefeatRule flags that end this game
+    uint32_t last_lock_rows;        // bit y is set when the last locked piece had a block in row y
 
     uint32_t seed;                  // for playing a certain game
+    struct Rng rng;                 // random number generator of this game, seeded with seed
+    struct Randomizer randomizer;   // decides which pieces are put into the preview queue
+    enum RotationSystem rotation_system;
 };
 
-/* List of Pieces:
-
-first number in matrix says which block it is (scales one greater than below)
-
- O-Block   L-Block     J-Block      T-Block
- { 1 1     { 0 2 0     { 0 3 0      { 0 0 0
-   1 1 }     0 2 0       0 3 0        4 4 4
-             0 2 2 }     3 3 0 }      0 4 0 }
-
- I-Block      Z-Block    S-Block
- { 0 0 5 0    { 0 0 0    { 0 0 0
-   0 0 5 0      6 6 0      0 7 7
-   0 0 5 0      0 6 6 }    7 7 0 }
-   0 0 5 0 }
+/*
+    Rules that end the game, they can be combined as flags.
 */
-
-enum Piece {
-    PIECE_O, PIECE_L, PIECE_J, PIECE_T, PIECE_I, PIECE_Z, PIECE_S
+enum DefeatRule {
+    DEFEAT_BLOCK_OUT        = 1 << 0,   // a newly spawned piece overlaps blocks of the arena
+    DEFEAT_LOCK_OUT         = 1 << 1,   // a piece locks with all of its blocks inside the spawn zone
+    DEFEAT_PARTIAL_LOCK_OUT = 1 << 2,   // a piece locks with any of its blocks inside the spawn zone
 };
 
 enum Direction {
@@ -91,15 +168,69 @@ enum Direction {
     the arena and meta information of the game.
     An initial seed can be given or the sentinal value 0.
     When 0 is given as the initial_seed, then the current time will become a "pseudo-random" seed.
-    If memory couldn't be allocated for the various arrays, the programs exits with ENOMEM.
+    The struct owns no heap memory, so nothing has to be freed when the game is discarded.
 */
 struct GameData init_gamedata(uint32_t initial_seed);
 
 /*
-    Frees the heap allocated arrays of the given instance of the GameData struct.
-    The pointer given is not freed itself.
+    Same as init_gamedata, but the arena size, randomizer, rotation and defeat rules are taken from the given config.
+    init_gamedata uses the config returned by default_game_config.
+*/
+struct GameData init_gamedata_with_config(uint32_t initial_seed, const struct GameConfig* config);
+
+/*
+    Returns the config of the classic game: a 10 x 20 arena, uniformly drawn pieces and a single next piece.
+    Held side buttons repeat every 0.2 seconds and pieces lock as soon as gravity pushes them into the ground.
+*/
+struct GameConfig default_game_config();
+
+/*
+    Returns the config that goes with the given rule set:
+        RULES_CLASSIC:   the same as default_game_config
+        RULES_NES:       NES randomizer, no kicks, one next piece, NES auto shift and no lock delay
+        RULES_GUIDELINE: 7-bag, SRS, five next pieces, half a second lock delay with 15 resets, lock out
+    For RULES_CUSTOM the classic config is returned, custom_rules has to be set by the caller.
+*/
+struct GameConfig rule_set_config(enum RuleSetType rule_set);
+
+/*
+    Returns the rule set selected by the config and stores a pointer to its rules in rules.
+    RULES_CUSTOM without custom_rules or with rules that fail rules_valid (like lines_per_level 0)
+    and invalid rule sets fall back to the classic rules.
+*/
+enum RuleSetType get_rule_set(const struct GameConfig* config, const struct RuleSet** rules);
+
+/*
+    Returns the features of the arena of the given game. They are updated by the engine and must not be changed.
 */
-void free_gamedata(struct GameData* game_data);
+static inline const struct BoardFeatures* get_board_features(const struct GameData* game_data)
+{
+    return &game_data->features;
+}
+
+/*
+    Returns the zobrist hash of the arena and the current piece, rotation and position of the given game.
+    The engine updates it incrementally whenever a piece moves, rotates, locks or rows are cleared.
+*/
+static inline uint64_t get_gamedata_hash(const struct GameData* game_data)
+{
+    return game_data->hash;
+}
+
+/*
+    Computes the zobrist hash of the given game from scratch. It is equal to get_gamedata_hash
+    unless the fields of the game were changed without going through the engine.
+*/
+uint64_t calc_gamedata_hash(const struct GameData* game_data);
+
+/*
+    Returns the upcoming piece with the given index, 0 is the next piece.
+    The index has to be smaller than the preview depth of the game.
+*/
+static inline enum Piece get_next_piece(const struct GameData* game_data, int index)
+{
+    return piece_queue_peek(&game_data->preview, index);
+}
 
 
 // Helper funtions for array index conversion: /////////////////////////////////
@@ -118,22 +249,23 @@ size_t coords_to_array_index(size_t x, size_t y, size_t width);
 
 ////////////////////////////////////////////////////////////////////////////////
 
-/*
-    Generate the next tetris piece as an heap allocated array of integer values.
-    The array consits of the type of the piece on the first position followed by the values
-    which have to be interpreted as a 2d matrix.
-    When memory couldn't be allocated the program exits with error code ENOMEM.
-*/
-int* generate_next_piece();
-
 /*
     Rotates a tetris piece clockwise or counter-clockwise depending on the given dir.
+    The kicks of the rotation system of the game are tried in order and the first position where the
+    rotated piece fits is taken. If none fits, the piece keeps its orientation and position.
 
     dir == LEFT  => rotate counter-clockwise
     dir == RIGHT => rotate clockwise
 */
 void rotate_piece(struct GameData* game_data, enum Direction dir);
 
+/*
+    Checks if the given piece in the given orientation and position overlaps the walls, the floor
+    or any piece in the arena. This is a single pass over the row masks of the piece.
+    Rows above the arena are treated as empty.
+*/
+bool piece_collides(const struct GameData* game_data, enum Piece piece, int rotation, int position_x, int position_y);
+
 /*
     Checks if the current piece collides with the wall of the arena or if out of bounds of the arena.
     Returns true when the collision/out of bounds happens and false if it doesn't.
@@ -161,20 +293,42 @@ void move(struct GameData* game_data, enum Direction dir);
 */
 size_t drop(struct GameData* game_data);
 
+/*
+    Moves the current piece down by up to rows rows without locking it and returns the number of rows it moved.
+    The distance to the ground is taken from get_ghost_row, so a fall over many rows costs a single query.
+*/
+int fall(struct GameData* game_data, int rows);
+
+/*
+    Moves the current piece straight down as far as possible and locks it in the same way drop does.
+    Returns the number of cleared rows.
+*/
+size_t hard_drop(struct GameData* game_data);
+
+/*
+    Returns the position_y the current piece would land on if it fell straight down (ghost piece).
+    When the piece is above all blocks below it, the row is computed from the column heights
+    in O(piece width), otherwise the piece is moved down row by row.
+*/
+int get_ghost_row(const struct GameData* game_data);
+
 /*
     Generates an array which contains all arena pieces and the current piece copied in to the
     correct location. This is used for rendering the pieces.
+    The cells of the ghost piece (see get_ghost_row) are written as the negated block id of the current piece.
 
-    The values will be written into the provided pointer. It should have size 200 or the program might crash.
+    The values will be written into the provided pointer row after row. It should have size width * height
+    of the arena (200 for the standard arena) or the program might crash.
 */
 void generate_block_positions(const struct GameData* game_data, int* block_positions);
 
-void check_defeat(struct GameData* game_data);
-
-static inline double calc_drop_time(const struct GameData* game_data)
-{
-    return BASE_TIME - log((game_data->level + 1)) * TIME_OFFSET;
-}
+/*
+    Applies the defeat rules of the game to the last locked piece and the current piece,
+    sets is_defeat accordingly and returns it.
+    Every rule is a single mask test against the top rows of the arena.
+    This is called by the engine whenever a new piece spawns.
+*/
+bool check_defeat(struct GameData* game_data);
 
 void spawn_new_piece(struct GameData* game_data);
 
@@ -0,0 +1,69 @@
+#ifndef ENV_H_
+#define ENV_H_
+
+#include "batch.h"
+#include "engine.h"
+
+// incremented whenever the layout of struct Env or the meaning of a function of this header changes
+#define ENV_API_VERSION 1
+
+/*
+    A single game driven by discrete actions, in the style of reinforcement learning environments:
+    reset starts an episode, step applies one action and reports the reward and the end of the episode,
+    observe exports the state.
+
+    The environment lives in memory owned by the caller (a variable, an array or a buffer of env_size bytes
+    aligned to CACHE_LINE_SIZE) and none of the functions allocate. Bindings of other languages can treat
+    it as an opaque block of memory and only use the functions below.
+*/
+struct Env {
+    struct GameData game_data;
+    struct GameConfig config;       // used by every reset
+    uint32_t seed;                  // seed of the current episode
+    uint32_t episode;               // number of resets since env_create
+    int gravity_steps;              // the piece falls by one row every gravity_steps steps, 0 disables gravity (default 1)
+    int gravity_timer;              // steps since the piece last fell
+};
+
+/*
+    Returns ENV_API_VERSION of the library, so bindings can check it against the header they were written for.
+*/
+int env_api_version(void);
+
+/*
+    Returns the number of bytes of a struct Env.
+*/
+size_t env_size(void);
+
+/*
+    Sets up an environment in the given memory and starts its first episode.
+    A seed of 0 picks a seed from the current time, a config of NULL selects default_game_config.
+*/
+void env_create(struct Env* env, uint32_t seed, const struct GameConfig* config);
+
+/*
+    Starts a new episode with the given seed. A seed of 0 continues with the seed after the one of the current episode.
+*/
+void env_reset(struct Env* env, uint32_t seed);
+
+/*
+    Applies the given enum Action to the current piece, followed by gravity.
+    The points scored in this step are written to reward if it isn't NULL.
+    Returns true when the episode is over; further steps do nothing until env_reset is called.
+*/
+bool env_step(struct Env* env, int action, float* reward);
+
+/*
+    Returns the number of bytes env_observe writes for the given environment.
+*/
+size_t env_observation_size(const struct Env* env);
+
+/*
+    Writes the state of the game into buffer, which has to hold env_observation_size bytes:
+        width * height bytes with the cells of the arena row after row, 0 empty, 1 block, 2 current piece
+        1 byte with the enum Piece of the current piece
+        preview depth bytes with the enum Piece of the upcoming pieces, the next piece first
+*/
+void env_observe(const struct Env* env, uint8_t* buffer);
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef EVALUATOR_H_
+#define EVALUATOR_H_
+
+#include "board.h"
+#include "movegen.h"
+#include "pieces.h"
+
+// placements that are rated with one call of the evaluator
+#define EVAL_CHUNK 256
+
+/*
+    Features of a board after a piece was placed, as used by the heuristics of Dellacherie and El-Tetris.
+    Transitions and wells treat the side walls and the floor as filled cells.
+*/
+enum EvalFeature {
+    EVAL_LANDING_HEIGHT,        // height of the middle of the placed piece above the floor
+    EVAL_ERODED_CELLS,          // cleared rows times the cells of the placed piece in them
+    EVAL_ROW_TRANSITIONS,       // changes between filled and empty cells along the rows
+    EVAL_COLUMN_TRANSITIONS,    // changes between filled and empty cells down the columns
+    EVAL_HOLES,                 // empty cells below the top most block of their column
+    EVAL_WELLS,                 // cumulative wells: a well of depth d adds 1 + 2 + ... + d
+    EVAL_AGGREGATE_HEIGHT,      // sum of the column heights
+    EVAL_BUMPINESS,             // sum of the height differences of neighbouring columns
+    EVAL_MAX_HEIGHT,
+    EVAL_FEATURES,
+};
+
+/*
+    The implementations of the evaluator. They compute the same results, the SIMD ones evaluate
+    several boards at once, one board per 64 bit lane.
+*/
+enum EvalKernel {
+    EVAL_KERNEL_SCALAR,
+    EVAL_KERNEL_SSE2,           // 2 boards at once
+    EVAL_KERNEL_AVX2,           // 4 boards at once
+};
+
+struct Evaluator {
+    float weights[EVAL_FEATURES];
+    enum EvalKernel kernel;     // set by init_evaluator to the best kernel the CPU supports
+};
+
+// the weights of El-Tetris, tuned for the Dellacherie features
+static const float EL_TETRIS_WEIGHTS[EVAL_FEATURES] = {
+    [EVAL_LANDING_HEIGHT]     = -4.500158825082766f,
+    [EVAL_ERODED_CELLS]       =  3.4181268101392694f,
+    [EVAL_ROW_TRANSITIONS]    = -3.2178882868487753f,
+    [EVAL_COLUMN_TRANSITIONS] = -9.348695305445199f,
+    [EVAL_HOLES]              = -7.899265427351652f,
+    [EVAL_WELLS]              = -3.3855972247263626f,
+};
+
+/*
+    Sets up an evaluator with the given weights (EVAL_FEATURES of them) and the fastest kernel of the CPU.
+*/
+void init_evaluator(struct Evaluator* evaluator, const float* weights);
+
+/*
+    Returns true when the CPU can run the given kernel.
+*/
+bool eval_kernel_supported(enum EvalKernel kernel);
+
+/*
+    Rates count boards: score i is the sum of the weighted features of board i, higher is better.
+    The height rows of board i start at rows[i * height]. landing_heights and eroded_cells hold the
+    features of the placement that led to every board, either of them can be NULL for boards without a placement.
+*/
+void evaluate_boards(const struct Evaluator* evaluator, const arena_row_t* rows, int count, int width, int height,
+                     const float* landing_heights, const uint8_t* eroded_cells, float* scores);
+
+/*
+    Computes the features of a single board without a placement, the first two features are 0.
+*/
+void extract_board_features(const arena_row_t* rows, int width, int height, int features[EVAL_FEATURES]);
+
+/*
+    Returns the landing height of a piece that locks with its top left corner in row position_y.
+*/
+static inline float landing_height(enum Piece piece, int rotation, int position_y, int height)
+{
+    const struct PieceShape* shape = get_piece_shape(piece, rotation);
+    return height - position_y - (shape->min_y + shape->max_y) * 0.5f;
+}
+
+/*
+    Returns the eroded cells of the given piece locking in the given position of the rows, before it is written into them.
+*/
+int eroded_piece_cells(const arena_row_t* rows, int width, enum Piece piece, int rotation, int position_x, int position_y);
+
+/*
+    Scratch memory of a thread of a bot that rates placements, allocated once so that the search itself never allocates.
+*/
+struct PlacementRatings {
+    struct PlacementList list;
+    arena_row_t rows[EVAL_CHUNK * ARENA_MAX_HEIGHT];    // boards after the placements that are rated
+    float landing_heights[EVAL_CHUNK];
+    uint8_t eroded_cells[EVAL_CHUNK];
+    float scores[EVAL_CHUNK];                           // ratings of the boards, see evaluate_boards
+};
+
+/*
+    Rates the boards after the placements first to first + count of the list, which belongs to the current piece
+    of the game, into ratings->scores. At most EVAL_CHUNK placements are rated at once.
+*/
+void rate_placements(const struct Evaluator* evaluator, const struct GameData* game_data, const struct PlacementList* list,
+                     int first, int count, struct PlacementRatings* ratings);
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <stdio.h>
 
-void print_piece(const int* piece, int size);
+#include "pieces.h"
 
-#endif
\ No newline at end of file
+void print_piece(enum Piece piece, int rotation);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef MOVEGEN_H_
+#define MOVEGEN_H_
+
+#include "engine.h"
+
+// the piece positions a search can visit, bounded by the rotations, the columns (blocks may stick out to the left
+// by up to 3 columns) and the rows of the largest arena plus some room above it
+#define PLACEMENT_MAX_NODES (PIECE_ROTATIONS * (ARENA_MAX_WIDTH + 3) * (ARENA_MAX_HEIGHT + 8))
+
+/*
+    The inputs that lead the current piece to a placement. They are applied with the engine functions of the same name.
+*/
+enum PlacementStep {
+    STEP_LEFT,              // move LEFT
+    STEP_RIGHT,             // move RIGHT
+    STEP_ROTATE_RIGHT,      // rotate_piece RIGHT
+    STEP_ROTATE_LEFT,       // rotate_piece LEFT
+    STEP_DROP,              // fall down to the ground without locking
+};
+
+/*
+    A position of the current piece that was reached by the search.
+    The steps are kept as a tree: every node remembers the node it was reached from.
+*/
+struct PlacementNode {
+    int8_t rotation;
+    int8_t position_x;
+    int8_t position_y;
+    uint8_t step;           // enum PlacementStep that led here from parent
+    uint16_t parent;        // index of the previous node, the first node is the position of the current piece
+};
+
+/*
+    A position in which the current piece rests on the ground, so a hard drop locks it there.
+*/
+struct Placement {
+    int8_t rotation;
+    int8_t position_x;
+    int8_t position_y;
+    uint16_t node;          // the node of the search that reached this position first
+};
+
+/*
+    The result of generate_placements. It is large, so it should be reused instead of being placed on the stack per call.
+*/
+struct PlacementList {
+    int count;
+    int node_count;
+    struct Placement placements[PLACEMENT_MAX_NODES];
+    struct PlacementNode nodes[PLACEMENT_MAX_NODES];
+};
+
+/*
+    Finds every position the current piece can lock in by a breadth first search over its positions
+    (rotation, x and y) starting from where it is now. The piece moves with the rules of the engine:
+    side moves, rotations with the kicks of the rotation system and drops to the ground, so placements
+    that need a tuck under an overhang or a spin are included. Rotating or moving while the piece is
+    falling through mid-air is not explored, only at the height it is at and on the ground.
+
+    Positions that cover the same cells are reported once (like the rotations of the O piece), with the shortest path.
+    Collisions are tested against a bitmask per rotation and column that is built once from the column masks of the board
+    features, so every step of the search is a single bit test.
+
+    Returns the number of placements.
+*/
+int generate_placements(const struct GameData* game_data, struct PlacementList* list);
+
+/*
+    Writes the steps that lead the current piece to the placement with the given index into steps and
+    returns their number. At most max_steps are written, the number returned can be larger.
+*/
+int get_placement_path(const struct PlacementList* list, int index, uint8_t* steps, int max_steps);
+
+/*
+    Writes the rows of the arena of the game as they would be after the current piece locked in the given placement
+    into rows (height of them), with the filled rows removed. The game isn't changed.
+*/
+void write_placement_rows(const struct GameData* game_data, const struct Placement* placement, arena_row_t* rows);
+
+/*
+    Applies one step of a path to the current piece with the engine function it stands for, without locking it.
+*/
+void play_placement_step(struct GameData* game_data, enum PlacementStep step);
+
+/*
+    Moves the current piece along the path of the placement with the given index and hard drops it.
+    The game has to be in the state the placements were generated for.
+    Returns the number of cleared rows.
+*/
+size_t play_placement(struct GameData* game_data, const struct PlacementList* list, int index);
+
+#endif
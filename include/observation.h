@@ -0,0 +1,69 @@
+#ifndef OBSERVATION_H_
+#define OBSERVATION_H_
+
+#include "batch.h"
+#include "engine.h"
+
+/*
+    Encoders that export the state of games for learning agents.
+    They write into memory provided by the caller and read the bitboard directly, without going through
+    generate_block_positions. Cells are numbered row after row from the top left, like the arena.
+
+    bits:          one bit per cell, cell i is bit i % 8 of byte i / 8 (25 bytes for the standard arena)
+    board plane:   one float per cell, 1 for a block and 0 for an empty cell
+    piece one-hot: PIECE_TYPES floats, 1 at the index of the enum Piece
+    heights:       one float per column, the number of rows from the floor up to its top most block
+
+    An observation is the concatenation of the board plane, the one-hot of the current piece,
+    the one-hots of the preview pieces and the column heights.
+*/
+
+/*
+    Returns the number of bytes of the bit-packed board of an arena of the given size.
+*/
+static inline size_t board_bits_size(int width, int height)
+{
+    return ((size_t)width * height + 7) / 8;
+}
+
+/*
+    Returns the number of floats of an observation for the given arena size and preview depth.
+*/
+static inline size_t observation_size(int width, int height, int preview_depth)
+{
+    return (size_t)width * height + PIECE_TYPES * (1 + (size_t)preview_depth) + width;
+}
+
+/*
+    Writes the bit-packed board of the game into buffer and returns the number of bytes written.
+*/
+size_t encode_board_bits(const struct GameData* game_data, uint8_t* buffer);
+
+void encode_board_plane(const struct GameData* game_data, float* plane);
+
+void encode_piece_one_hot(enum Piece piece, float* one_hot);
+
+/*
+    Writes the one-hots of all preview pieces of the game, the next piece first.
+*/
+void encode_preview_one_hot(const struct GameData* game_data, float* one_hot);
+
+void encode_column_heights(const struct GameData* game_data, float* heights);
+
+/*
+    Writes the complete observation of the game, observation_size floats.
+*/
+void encode_observation(const struct GameData* game_data, float* observation);
+
+/*
+    Same as encode_board_bits for every game of the batch, game i starts at byte i * board_bits_size.
+*/
+void encode_batch_board_bits(const struct BatchGames* batch, uint8_t* buffer);
+
+/*
+    Same as encode_observation for every game of the batch. The observations form a contiguous
+    count x observation_size tensor, game i starts at float i * observation_size.
+*/
+void encode_batch_observations(const struct BatchGames* batch, float* observations);
+
+#endif
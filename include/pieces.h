@@ -0,0 +1,64 @@
+#ifndef PIECES_H_
+#define PIECES_H_
+
+#include <inttypes.h>
+
+#define PIECE_TYPES     7
+#define PIECE_ROTATIONS 4
+#define PIECE_BLOCKS    4               // every tetris piece consists of 4 blocks
+
+/* List of Pieces:
+
+first number in matrix says which block it is (scales one greater than below)
+
+ O-Block   L-Block     J-Block      T-Block
+ { 1 1     { 0 2 0     { 0 3 0      { 0 0 0
+   1 1 }     0 2 0       0 3 0        4 4 4
+             0 2 2 }     3 3 0 }      0 4 0 }
+
+ I-Block      Z-Block    S-Block
+ { 0 0 5 0    { 0 0 0    { 0 0 0
+   0 0 5 0      6 6 0      0 7 7
+   0 0 5 0      0 6 6 }    7 7 0 }
+   0 0 5 0 }
+
+The matrices above are rotation 0. Rotation r is the matrix rotated clockwise r times.
+*/
+
+enum Piece {
+    PIECE_O, PIECE_L, PIECE_J, PIECE_T, PIECE_I, PIECE_Z, PIECE_S
+};
+
+/*
+    Precomputed shape of a piece in one orientation.
+    All coordinates are relative to the top left corner of the piece matrix.
+*/
+struct PieceShape {
+    int8_t cells[PIECE_BLOCKS][2];      // x and y of the 4 blocks, ordered top to bottom and left to right
+    uint16_t row_masks[4];              // occupancy of every matrix row, bit x is set when column x is filled
+    int8_t min_x, max_x;                // bounding box of the blocks inside the matrix
+    int8_t min_y, max_y;
+    int8_t column_bottoms[4];           // y of the lowest block in every matrix column, -1 for empty columns
+};
+
+// the shape of every piece type in all 4 orientations
+extern const struct PieceShape PIECE_SHAPES[PIECE_TYPES][PIECE_ROTATIONS];
+
+// the width of the square matrix of every piece type
+extern const int PIECE_SIZES[PIECE_TYPES];
+
+static inline const struct PieceShape* get_piece_shape(enum Piece piece, int rotation)
+{
+    return &PIECE_SHAPES[piece][rotation];
+}
+
+/*
+    The value that is written into the color plane of the arena for a piece type.
+    0 is an empty cell, so the ids start at 1.
+*/
+static inline int get_piece_block_id(enum Piece piece)
+{
+    return (int)piece + 1;
+}
+
+#endif
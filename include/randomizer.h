@@ -0,0 +1,75 @@
+#ifndef RANDOMIZER_H_
+#define RANDOMIZER_H_
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "pieces.h"
+#include "rng.h"
+
+// maximum number of upcoming pieces that can be previewed, has to be a power of two
+#define PREVIEW_MAX_DEPTH 8
+
+enum RandomizerType {
+    RANDOMIZER_UNIFORM,     // every piece is drawn independently with the same probability
+    RANDOMIZER_BAG,         // all 7 pieces are dealt in a random order before the next bag starts
+    RANDOMIZER_NES,         // like uniform, but a repeat of the previous piece is rerolled once
+    RANDOMIZER_TYPES
+};
+
+/*
+    State of a piece randomizer. Which fields are used depends on the type.
+    Contains no pointers, so it can be copied together with the game it belongs to.
+*/
+struct Randomizer {
+    enum RandomizerType type;
+
+    enum Piece bag[PIECE_TYPES];    // 7-bag: the pieces in bag[0 .. bag_left - 1] haven't been dealt yet
+    int bag_left;
+
+    enum Piece last;                // NES: the previously drawn piece
+};
+
+/*
+    Ring buffer of the upcoming pieces.
+    The pieces in pieces[head], pieces[head + 1], ... pieces[head + depth - 1] (wrapped around) are valid.
+*/
+struct PieceQueue {
+    enum Piece pieces[PREVIEW_MAX_DEPTH];
+    int head;
+    int depth;
+};
+
+/*
+    Initializes the state of a randomizer of the given type.
+*/
+void init_randomizer(struct Randomizer* randomizer, enum RandomizerType type);
+
+/*
+    Draws the next piece from the randomizer using the given random number generator.
+    Runs in constant time and never allocates.
+*/
+enum Piece randomizer_next(struct Randomizer* randomizer, struct Rng* rng);
+
+/*
+    Fills the queue with depth pieces drawn from the randomizer.
+    The depth is clamped to [1, PREVIEW_MAX_DEPTH].
+*/
+void init_piece_queue(struct PieceQueue* queue, int depth, struct Randomizer* randomizer, struct Rng* rng);
+
+/*
+    Removes the first piece from the queue and appends a freshly drawn one.
+    Returns the removed piece.
+*/
+enum Piece piece_queue_pop(struct PieceQueue* queue, struct Randomizer* randomizer, struct Rng* rng);
+
+/*
+    Returns the upcoming piece with the given index, 0 is the piece that will be spawned next.
+    The index has to be smaller than the depth of the queue.
+*/
+static inline enum Piece piece_queue_peek(const struct PieceQueue* queue, int index)
+{
+    return queue->pieces[(queue->head + index) & (PREVIEW_MAX_DEPTH - 1)];
+}
+
+#endif
@@ -5,6 +5,9 @@
 #include "error.h"
 #include "init.h"
 
+// number of cells the block shader can draw, the size of block_positions in vertex_blocks.glsl
+#define RENDER_MAX_BLOCKS (ARENA_WIDTH * ARENA_HEIGHT)
+
 void draw_gl(GLFWwindow* window);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef RNG_H_
+#define RNG_H_
+
+#include <inttypes.h>
+
+/*
+    State of a xoshiro128** pseudo random number generator.
+    Every game owns one, so games don't share any global state and always produce the same
+    sequence for the same seed, independent of other games running in the same process.
+    source: https://prng.di.unimi.it/xoshiro128starstar.c
+*/
+struct Rng {
+    uint32_t state[4];
+};
+
+static inline uint32_t rng_rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+/*
+    Initializes the generator from a seed.
+    The state is filled with splitmix64 so that similar seeds give unrelated sequences
+    and the state can never become all zeros.
+*/
+static inline void rng_seed(struct Rng* rng, uint64_t seed)
+{
+    for (int i = 0; i < 4; i += 2) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z = z ^ (z >> 31);
+
+        rng->state[i]     = (uint32_t)z;
+        rng->state[i + 1] = (uint32_t)(z >> 32);
+    }
+}
+
+/*
+    Returns the next 32 bit random number and advances the generator.
+*/
+static inline uint32_t rng_next(struct Rng* rng)
+{
+    uint32_t* s = rng->state;
+    uint32_t result = rng_rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+
+    s[2] ^= t;
+    s[3] = rng_rotl(s[3], 11);
+
+    return result;
+}
+
+/*
+    Returns an uniformly distributed random number in [0, bound).
+    Uses the multiply and shift method instead of a modulo and rejects the few values
+    that would make the result biased.
+    source: https://arxiv.org/abs/1805.10941
+*/
+static inline uint32_t rng_range(struct Rng* rng, uint32_t bound)
+{
+    uint64_t m = (uint64_t)rng_next(rng) * bound;
+    uint32_t low = (uint32_t)m;
+
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            m = (uint64_t)rng_next(rng) * bound;
+            low = (uint32_t)m;
+        }
+    }
+
+    return (uint32_t)(m >> 32);
+}
+
+#endif
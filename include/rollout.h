@@ -0,0 +1,91 @@
+#ifndef ROLLOUT_H_
+#define ROLLOUT_H_
+
+#include "engine.h"
+#include "evaluator.h"
+#include "movegen.h"
+#include "thread_pool.h"
+#include "undo.h"
+
+#define ROLLOUT_MAX_CANDIDATES 32
+
+// value added for every piece a rollout couldn't place because the game was lost, far below any rating
+#define ROLLOUT_DEFEAT_PENALTY -1e5f
+
+struct RolloutConfig {
+    int candidates;             // best rated placements of the current piece that are rolled out (default 8)
+    int samples;                // rollouts per search, split evenly across the candidates (default 256)
+    int depth;                  // pieces placed by a rollout after the candidate (default 4)
+    int threads;                // threads of the search including the caller, 0 uses one per processor
+    uint64_t seed;              // seed of the rollouts, mixed with the hash of the searched game
+    float weights[EVAL_FEATURES];   // weights of the evaluator (default EL_TETRIS_WEIGHTS)
+};
+
+/*
+    Scratch memory of a thread, allocated once so that the search itself never allocates.
+    The board is reused by every rollout of the thread, its rng draws the sampled pieces.
+*/
+struct RolloutThread {
+    struct GameData board;
+    struct PlacementRatings ratings;    // the placements of the board and their ratings
+};
+
+/*
+    Bot that averages over the pieces the randomizer may deal beyond the preview. The best rated placements
+    of the current piece are the candidates, every candidate is played by samples / candidates rollouts
+    and the one with the best mean value is chosen. A rollout places depth more pieces greedily with the
+    evaluator, its value is the sum of the ratings of all boards on the way.
+
+    The rng of the rollout board is reseeded per rollout before the candidate is placed, so pieces past the
+    preview are drawn from the distribution of the randomizer instead of the future of the searched game.
+    Rollout s of every candidate uses the same seed, so the candidates are compared on the same piece sequences.
+
+    The rollouts are spread across a thread pool. Every rollout writes its own value and the values are summed
+    in order afterwards, so the result doesn't depend on the number of threads.
+
+    The speedup with more threads hasn't been measured, the search was only run on a single processor. It is bounded:
+    generating and rating the placements of the current piece and selecting the candidates run on the calling thread,
+    and with samples close to the number of threads the rollouts, dealt out one at a time, don't split evenly.
+*/
+struct RolloutSearch {
+    struct RolloutConfig config;
+    struct Evaluator evaluator;
+    struct ThreadPool pool;
+
+    struct PlacementList* root_list;    // placements of the searched game, the result indexes them
+    const struct GameData* game_data;   // the searched game
+    uint64_t seed;                      // seed of rollout 0 of the current search
+    int candidate_count;
+    int candidates[ROLLOUT_MAX_CANDIDATES];     // indices into root_list, best rated first
+    float ratings[ROLLOUT_MAX_CANDIDATES];      // ratings of the boards after the candidates
+    float means[ROLLOUT_MAX_CANDIDATES];        // mean values of the rollouts of the last search
+    int rollouts;                       // rollouts per candidate
+    float* values;                      // value of every rollout, candidate_count * rollouts of them
+    struct RolloutThread* threads;
+
+    uint64_t nodes;                     // placements rated by the last search
+};
+
+struct RolloutConfig default_rollout_config(void);
+
+/*
+    Allocates the memory and the threads of the search. Returns false when the memory can't be allocated.
+    Threads that can't be started are left out: the search then runs on fewer threads and config.threads holds their number.
+    The search keeps pointers into itself, it must not be moved after init_rollout_search.
+*/
+bool init_rollout_search(struct RolloutSearch* search, const struct RolloutConfig* config);
+
+void destroy_rollout_search(struct RolloutSearch* search);
+
+/*
+    Searches the best placement of the current piece of the game. Returns its index in search->root_list
+    or -1 when the piece has no placement.
+*/
+int rollout_search_best(struct RolloutSearch* search, const struct GameData* game_data);
+
+/*
+    Searches the best placement and plays it with play_placement. Returns false when there is none.
+*/
+bool rollout_search_play(struct RolloutSearch* search, struct GameData* game_data);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef ROTATION_H_
+#define ROTATION_H_
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "pieces.h"
+
+// maximum number of positions that are tried for one rotation
+#define MAX_KICKS 5
+
+enum RotationSystem {
+    ROTATION_CLASSIC,       // the piece only rotates in place, a blocked rotation fails
+    ROTATION_SRS,           // Super Rotation System: up to 4 alternative positions are tried (wall kicks)
+    ROTATION_SYSTEMS
+};
+
+/*
+    The positions that are tried in order when a piece is rotated.
+    Every kick is an offset in arena coordinates (y points downwards) that is added to the position
+    of the rotated piece. The first offset that doesn't collide is taken.
+*/
+struct KickList {
+    int count;
+    int8_t offsets[MAX_KICKS][2];
+};
+
+/*
+    Returns the kicks for rotating the given piece from its rotation from_rotation
+    clockwise (clockwise == true) or counter-clockwise.
+*/
+const struct KickList* get_rotation_kicks(enum RotationSystem system, enum Piece piece, int from_rotation, bool clockwise);
+
+#endif
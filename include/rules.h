@@ -0,0 +1,145 @@
+#ifndef RULES_H_
+#define RULES_H_
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <math.h>
+
+#ifdef DEBUG
+    #define BASE_TIME .2
+#else
+    #define BASE_TIME   1.0
+#endif
+#define TIME_OFFSET .285
+
+// the game is simulated in fixed steps of 1 / TICK_RATE seconds (see tick.h)
+#define TICK_RATE 60
+#define TICK_TIME (1.0 / TICK_RATE)
+
+#define SECONDS_TO_TICKS(seconds) ((uint32_t)((seconds) * TICK_RATE + 0.5))
+
+// gravity is measured in cells per tick as a fixed point number with GRAVITY_SHIFT fractional bits
+#define GRAVITY_SHIFT 16
+#define GRAVITY_ONE (1u << GRAVITY_SHIFT)   // 1G: one cell per tick
+#define GRAVITY_MAX (20 * GRAVITY_ONE)      // 20G: pieces fall to the ground of the standard arena at once
+
+/*
+    The rules for scoring, levels and speed of a game.
+
+    The built-in rule sets below are constants visible to every file. The engine calls its kernels
+    with a pointer to one of them, so the compiler folds the tables and inlines the gravity function
+    into a separate copy of the kernel for every rule set. Only RULES_CUSTOM reads the rules at runtime.
+*/
+struct RuleSet {
+    const char* name;
+    uint32_t line_scores[5];        // points for clearing 0 - 4 rows at once, multiplied by the number of levels played
+    uint32_t first_level;           // level a game starts in
+    uint32_t lines_per_level;       // cleared lines needed to advance one level
+    uint32_t (*gravity)(uint32_t level);    // cells per tick at the given level, in units of GRAVITY_ONE
+};
+
+enum RuleSetType {
+    RULES_CLASSIC,      // the original rules of this game
+    RULES_NES,          // NES scoring and speed curve
+    RULES_GUIDELINE,    // modern guideline scoring and speed curve
+    RULES_CUSTOM,       // rules supplied in the config of the game
+    RULE_SETS,
+};
+
+/*
+    Converts the time a piece needs to fall by one cell into gravity, limited to GRAVITY_MAX.
+    The fraction is rounded up, so a piece that drops every n ticks moves exactly on the n-th tick.
+*/
+static inline uint32_t gravity_from_seconds(double seconds_per_cell)
+{
+    double ticks_per_cell = seconds_per_cell * TICK_RATE;
+    if (ticks_per_cell * GRAVITY_MAX <= GRAVITY_ONE) return GRAVITY_MAX;
+
+    return (uint32_t)ceil(GRAVITY_ONE / ticks_per_cell);
+}
+
+static inline uint32_t classic_gravity(uint32_t level)
+{
+    return gravity_from_seconds(BASE_TIME - log(level + 1) * TIME_OFFSET);
+}
+
+static inline uint32_t nes_gravity(uint32_t level)
+{
+    // frames per cell of the NTSC version, one frame is taken as one tick
+    static const uint8_t FRAMES_PER_CELL[29] = {
+        48, 43, 38, 33, 28, 23, 18, 13, 8, 6, 5, 5, 5, 4, 4, 4, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    };
+    uint32_t frames = (level < 29) ? FRAMES_PER_CELL[level] : 1;
+    return (GRAVITY_ONE + frames - 1) / frames;
+}
+
+static inline uint32_t guideline_gravity(uint32_t level)
+{
+    // beyond level 20 the curve is faster than GRAVITY_MAX and soon turns negative
+    double levels = (level > 20) ? 19 : (level > 0) ? level - 1 : 0;
+    return gravity_from_seconds(pow(0.8 - levels * 0.007, levels));
+}
+
+static const struct RuleSet CLASSIC_RULES = {
+    .name = "classic",
+    .line_scores = { 0, 40, 100, 300, 1200 },
+    .first_level = 0,
+    .lines_per_level = 10,
+    .gravity = classic_gravity,
+};
+
+static const struct RuleSet NES_RULES = {
+    .name = "nes",
+    .line_scores = { 0, 40, 100, 300, 1200 },
+    .first_level = 0,
+    .lines_per_level = 10,
+    .gravity = nes_gravity,
+};
+
+static const struct RuleSet GUIDELINE_RULES = {
+    .name = "guideline",
+    .line_scores = { 0, 100, 300, 500, 800 },
+    .first_level = 1,
+    .lines_per_level = 10,
+    .gravity = guideline_gravity,
+};
+
+/*
+    Calls function with the given arguments followed by a pointer to the rule set of the game.
+    For the built-in rule sets the pointer is a constant, which makes the compiler specialize
+    an inlined function for each of them. The selection is made once per call of the engine,
+    not inside its loops.
+*/
+#define WITH_RULE_SET(game_data, function, ...) \
+    ((game_data)->rule_set == RULES_CLASSIC   ? function(__VA_ARGS__, &CLASSIC_RULES) : \
+     (game_data)->rule_set == RULES_NES       ? function(__VA_ARGS__, &NES_RULES) : \
+     (game_data)->rule_set == RULES_GUIDELINE ? function(__VA_ARGS__, &GUIDELINE_RULES) : \
+                                                function(__VA_ARGS__, &(game_data)->rules))
+
+/*
+    Checks that a game can be played with the rules: levels need at least one line and the speed curve has to exist.
+    Rules supplied in a config are only used when they pass this check.
+*/
+static inline bool rules_valid(const struct RuleSet* rules)
+{
+    return rules->lines_per_level > 0 && rules->gravity != NULL;
+}
+
+/*
+    Returns the points for clearing the given number of rows at once in the given level.
+*/
+static inline uint32_t rules_line_score(const struct RuleSet* rules, size_t rows, uint32_t level)
+{
+    return rules->line_scores[rows] * (level - rules->first_level + 1);
+}
+
+/*
+    Returns the level reached after clearing the given number of lines.
+*/
+static inline uint32_t rules_level(const struct RuleSet* rules, uint32_t cleared_lines)
+{
+    return rules->first_level + cleared_lines / rules->lines_per_level;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef TETRIS_ENGINE_H_
+#define TETRIS_ENGINE_H_
+
+/*
+    Public header of libtetris_engine, the game logic without any window, OpenGL or audio dependency.
+
+    engine.h       games, moves, drops, board features and hashes
+    tick.h         fixed step simulation with inputs, DAS/ARR, gravity and lock delay
+    undo.h         snapshots and undoing locks
+    rules.h        rule sets for scoring, levels and speed
+    batch.h        many games stepped together in a struct of arrays
+    env.h          reset / step / observe interface for trainers and bindings
+    observation.h  bit-packed and one-hot encodings of games
+    movegen.h      every placement of the current piece with the inputs that reach it
+    evaluator.h    heuristic rating of many boards at once
+    beam_search.h  multithreaded beam search bot
+    rollout.h      bot that averages Monte-Carlo rollouts over the randomizer
+    thread_pool.h  threads that run the same task together
+
+    Build it with `make engine`, which creates build/libtetris_engine.a and build/libtetris_engine.so.
+*/
+
+#include "batch.h"
+#include "beam_search.h"
+#include "engine.h"
+#include "env.h"
+#include "evaluator.h"
+#include "movegen.h"
+#include "observation.h"
+#include "rollout.h"
+#include "rules.h"
+#include "thread_pool.h"
+#include "tick.h"
+#include "undo.h"
+
+#endif
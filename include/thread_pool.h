@@ -0,0 +1,70 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define THREAD_POOL_MAX_THREADS 64
+
+/*
+    The work of a thread pool: every thread calls it once per thread_pool_run with its index.
+*/
+typedef void (*thread_pool_task_t)(void* context, int thread, int thread_count);
+
+struct ThreadPool;
+
+struct ThreadPoolWorker {
+    struct ThreadPool* pool;
+    int thread;
+    pthread_t handle;
+};
+
+/*
+    A fixed set of threads that run the same task together. The thread calling thread_pool_run
+    takes part as thread 0, so a pool of one thread runs everything on the caller without any worker.
+    The workers keep a pointer to the pool, it must not be moved while they run.
+*/
+struct ThreadPool {
+    int thread_count;
+    struct ThreadPoolWorker workers[THREAD_POOL_MAX_THREADS];     // index 0 is unused, it is the calling thread
+
+    pthread_mutex_t mutex;
+    pthread_cond_t start;           // signaled when a new task is posted or the pool shuts down
+    pthread_cond_t done;            // signaled when the last worker finished the task
+
+    thread_pool_task_t task;
+    void* context;
+    unsigned generation;            // incremented for every task, so workers notice a new one
+    int running;                    // workers that haven't finished the current task
+    bool shutdown;
+};
+
+/*
+    Starts thread_count - 1 workers, thread_count is clamped to 1 - THREAD_POOL_MAX_THREADS.
+    Returns false if not all threads could be created, the pool then runs its tasks on the threads it got.
+*/
+bool init_thread_pool(struct ThreadPool* pool, int thread_count);
+
+/*
+    Runs the task on all threads of the pool and returns when every thread is done.
+*/
+void thread_pool_run(struct ThreadPool* pool, thread_pool_task_t task, void* context);
+
+/*
+    Stops and joins the workers.
+*/
+void destroy_thread_pool(struct ThreadPool* pool);
+
+/*
+    Returns the number of processors that are online, at least 1.
+*/
+int get_processor_count(void);
+
+/*
+    Allocates count elements of the given size aligned to CACHE_LINE_SIZE, so that the memory of one thread
+    never shares a cache line with the memory of another. Returns NULL on failure, the memory is released with free.
+*/
+void* allocate_aligned(size_t count, size_t size);
+
+#endif
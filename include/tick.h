@@ -0,0 +1,40 @@
+#ifndef TICK_H_
+#define TICK_H_
+
+#include "engine.h"
+
+// at most this many ticks are simulated for one frame, so a long stall doesn't freeze the game while it catches up
+#define MAX_TICKS_PER_FRAME 15
+
+/*
+    Buttons of a tick, they can be combined as flags.
+    The side buttons and soft drop are held: a side move happens when the button is pressed and repeats while it is held.
+    Rotations and the hard drop are actions that happen in every tick their flag is set.
+*/
+enum Input {
+    INPUT_LEFT          = 1 << 0,
+    INPUT_RIGHT         = 1 << 1,
+    INPUT_SOFT_DROP     = 1 << 2,
+    INPUT_ROTATE_RIGHT  = 1 << 3,   // clockwise
+    INPUT_ROTATE_LEFT   = 1 << 4,   // counter-clockwise
+    INPUT_HARD_DROP     = 1 << 5,
+};
+
+#define INPUT_HELD_MASK (INPUT_LEFT | INPUT_RIGHT | INPUT_SOFT_DROP)
+
+/*
+    Advances the game by one tick with the given combination of enum Input flags held.
+    The result only depends on the game and the inputs of every tick, never on the clock,
+    so a game can be replayed from its seed and inputs or simulated headless as fast as possible.
+
+    Returns the number of rows cleared during the tick.
+*/
+size_t game_tick(struct GameData* game_data, unsigned inputs);
+
+/*
+    Adds the time of a frame to the time not yet simulated and returns the number of ticks to run for the frame,
+    at most MAX_TICKS_PER_FRAME. Their time is taken from the accumulator, less than one tick is left over.
+*/
+int frame_ticks(double* accumulator, double frame_time);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef UNDO_H_
+#define UNDO_H_
+
+#include "engine.h"
+
+// number of locks an undo stack remembers, pushing more discards the oldest ones
+#define UNDO_STACK_CAPACITY 32
+
+/*
+    The state changed by one lock of a piece. Only the rows the piece touched are stored,
+    the rows above them are moved back by undoing the line clears.
+*/
+struct UndoEntry {
+    enum Piece piece;               // the locked piece and its state before the drop
+    int rotation;
+    int position_x;
+    int position_y;
+
+    int first_row;                  // rows the piece touched in the position it locked in
+    int row_count;
+    arena_row_t rows[PIECE_BLOCKS];                     // content of those rows before the lock
+    uint8_t colors[PIECE_BLOCKS][ARENA_MAX_WIDTH];
+    int cleared_count;
+    int8_t cleared_rows[PIECE_BLOCKS];                  // cleared rows from top to bottom
+
+    struct BoardFeatures features;
+    struct PieceQueue preview;
+    struct Randomizer randomizer;
+    struct Rng rng;
+
+    uint32_t score;
+    uint32_t level;
+    uint32_t cleared_lines;
+    bool is_defeat;
+    uint32_t last_lock_rows;
+    uint64_t arena_hash;
+    uint64_t hash;
+};
+
+/*
+    Ring buffer of the last UNDO_STACK_CAPACITY locks of a game. It owns no heap memory.
+*/
+struct UndoStack {
+    struct UndoEntry entries[UNDO_STACK_CAPACITY];
+    int top;                        // index of the next entry to write
+    int count;                      // number of locks that can be undone
+};
+
+/*
+    Copies the complete state of a game, so that it can be restored later with gamedata_restore.
+    GameData owns no heap memory, so this is a single copy of the struct.
+*/
+void gamedata_snapshot(const struct GameData* game_data, struct GameData* snapshot);
+
+/*
+    Replaces the state of a game with a snapshot taken by gamedata_snapshot.
+*/
+void gamedata_restore(struct GameData* game_data, const struct GameData* snapshot);
+
+void init_undo_stack(struct UndoStack* stack);
+
+/*
+    Same as drop and hard_drop, but when the current piece locks the change is pushed onto the undo stack.
+    Drops that don't lock the piece are not recorded.
+*/
+size_t drop_with_undo(struct GameData* game_data, struct UndoStack* stack);
+size_t hard_drop_with_undo(struct GameData* game_data, struct UndoStack* stack);
+
+/*
+    Reverts the last recorded lock: the piece is removed from the arena, the cleared rows are put back
+    and the piece is returned to the state it had before the drop. The spawned piece goes back into the preview.
+    Returns false if the stack is empty.
+*/
+bool undo_lock(struct GameData* game_data, struct UndoStack* stack);
+
+#endif
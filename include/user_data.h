@@ -3,6 +3,7 @@
 
 #include <SDL2/SDL.h>
 #include "engine.h"
+#include "tick.h"
 
 #include "glad/glad.h"
 
@@ -33,16 +34,16 @@ typedef struct
 
     // The model:
     double last_frame_time;
-    double time_since_last_drop;
-    double time_since_last_side_move;
+    double tick_accumulator;        // frame time not yet simulated, less than one tick after every frame
 
-    bool holding_right;
-    bool holding_left;
+    unsigned held_inputs;           // enum Input flags of the buttons currently held down
+    unsigned pressed_inputs;        // buttons pressed since the last tick, so short taps aren't lost
 
     struct GameData gameData;
 
     // uniform for instanced rendering
     GLint block_positions;
+    GLint arena_width_uniform;
     GLint background_sampler_uniform;
     GLint digit_pos_uniform;
     GLint digit_tex_uniform;
@@ -0,0 +1,50 @@
+#ifndef VERIFY_H_
+#define VERIFY_H_
+
+/*
+    Self checks of the engine that tetris-headless runs with --verify, next to its perft regression.
+    They replay seeded games through two paths that have to agree and compare the results.
+    Every check prints a summary line and returns the number of failures.
+*/
+
+/*
+    Plays random placements recording every lock, undoes them one by one and compares each state
+    with the one before the lock. After every move, rotation, drop, lock, line clear and undo the
+    incremental hash of the game is compared with calc_gamedata_hash.
+*/
+int verify_undo(void);
+
+/*
+    Runs the fixed tick simulation through cases with a known outcome: how many ticks frame_ticks
+    runs for stalls and for different frame rates, and that a game replayed with the same inputs
+    ends in the same state.
+*/
+int verify_ticks(void);
+
+/*
+    Steps a batch and one game of the engine per batch game with the same seeds and random actions,
+    and compares the rows, piece, score, lines, level, rewards and defeats after every step.
+*/
+int verify_batch(void);
+
+/*
+    Steps an environment and a game of the engine with the same seed and random actions, and compares
+    the rewards, the done flags and the observations with the arena and the current piece of the game.
+    Lost episodes are reset and continue with the game of the next seed.
+*/
+int verify_env(void);
+
+/*
+    Decodes the packed bits of games back into rows and compares them with the arena, checks the board plane
+    and column heights of their observations, and compares the encoders of a batch with the ones of single games.
+*/
+int verify_observations(void);
+
+/*
+    Rates random boards of several arena sizes with every kernel the CPU supports, with counts that aren't
+    a multiple of the boards of a SIMD step, and compares the scores with the scalar kernel and the scalar
+    kernel with the features of extract_board_features.
+*/
+int verify_evaluator(void);
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef ZOBRIST_H_
+#define ZOBRIST_H_
+
+#include <inttypes.h>
+
+#include "board.h"
+#include "pieces.h"
+
+/*
+    Zobrist keys for hashing positions of a game.
+    The hash of a position is the xor of the keys of all occupied cells of the arena and the keys of the
+    type, rotation and position of the current piece, so it can be updated incrementally by xoring
+    the keys of whatever changed.
+
+    The keys are not stored in a table. Each key is the splitmix64 finalizer applied to a unique index,
+    which costs a few multiplications, needs no initialization and can be used from any thread.
+*/
+
+// the kinds of keys, every kind has its own range of indices
+enum ZobristKind {
+    ZOBRIST_CELL,
+    ZOBRIST_PIECE,
+    ZOBRIST_ROTATION,
+    ZOBRIST_X,
+    ZOBRIST_Y,
+};
+
+static inline uint64_t zobrist_key(enum ZobristKind kind, int index)
+{
+    uint64_t z = ((uint64_t)kind << 32 | (uint32_t)index) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/*
+    Key of the occupied cell in column x and row y, independent of the width of the arena.
+*/
+static inline uint64_t zobrist_cell_key(int x, int y)
+{
+    return zobrist_key(ZOBRIST_CELL, y * ARENA_MAX_WIDTH + x);
+}
+
+/*
+    Xor of the keys of all occupied cells of the given bitboard row.
+*/
+static inline uint64_t zobrist_row_key(int y, arena_row_t row)
+{
+    uint64_t key = 0;
+    for (; row != 0; row &= row - 1) key ^= zobrist_cell_key(__builtin_ctzll(row), y);
+    return key;
+}
+
+/*
+    Key of the current piece, made of the keys of its type, rotation and position.
+    Positions can be negative or lie outside the arena as long as the blocks of the piece are inside.
+*/
+static inline uint64_t zobrist_piece_key(enum Piece piece, int rotation, int position_x, int position_y)
+{
+    return zobrist_key(ZOBRIST_PIECE, piece) ^ zobrist_key(ZOBRIST_ROTATION, rotation)
+         ^ zobrist_key(ZOBRIST_X, position_x) ^ zobrist_key(ZOBRIST_Y, position_y);
+}
+
+#endif
@@ -10,14 +10,14 @@ out vec2 f_tex_coords;
 out vec3 f_pos;
 out vec3 f_normal;
 
-// determines position and color of blocks
+// determines position and color of blocks, the size has to match RENDER_MAX_BLOCKS
 uniform int block_positions[200];
+uniform int arena_width;
 
 flat out int block_id;
 
 #define PI 3.1415
 #define scaling_factor .1
-#define ARENA_WIDTH 10
 #define starting_x -5 * scaling_factor + .05
 #define starting_y 10 * scaling_factor - .05
 
@@ -50,8 +50,8 @@ vec3 hsv2rgb(vec3 c)
 void main()
 {
     block_id = block_positions[gl_InstanceID];
-    int x = gl_InstanceID % ARENA_WIDTH;
-    int y = gl_InstanceID / ARENA_WIDTH;
+    int x = gl_InstanceID % arena_width;
+    int y = gl_InstanceID / arena_width;
 
     vec4 trans = vec4(starting_x + x * scaling_factor, starting_y - y * scaling_factor, -2.0, 0.0);
 
@@ -75,7 +75,9 @@ void main()
 
     gl_Position = frustum * vec4(pos, 1.0);
 
-    f_color = vec4(hsv2rgb(vec3(block_id * 2.0 * PI, 1, 1)), 1.0);
+    // the cells of the ghost piece carry the negated block id and are drawn darker
+    float brightness = (block_id < 0) ? 0.35 : 1.0;
+    f_color = vec4(hsv2rgb(vec3(abs(block_id) * 2.0 * PI, 1, brightness)), 1.0);
     f_tex_coords = v_tex_coords;
     f_pos = pos;
     f_normal = v_normal.xyz;
@@ -0,0 +1,234 @@
+#include "batch.h"
+
+/*
+    Helper function that rounds a size up to a multiple of the cache line size,
+    so that every array of the batch starts on its own cache line.
+*/
+static size_t align_size(size_t size)
+{
+    return (size + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+}
+
+/*
+    Helper function that hands out the next array of the given size from the memory of the batch.
+*/
+static void* take_memory(char** memory, size_t size)
+{
+    void* array = *memory;
+    *memory += align_size(size);
+    return array;
+}
+
+size_t batch_memory_size(int count, const struct GameConfig* config)
+{
+    int height = (config->height < ARENA_MIN_HEIGHT) ? ARENA_MIN_HEIGHT : (config->height > ARENA_MAX_HEIGHT) ? ARENA_MAX_HEIGHT : config->height;
+
+    return align_size(sizeof(arena_row_t) * count * height)
+         + align_size(sizeof(uint8_t) * count) * 2
+         + align_size(sizeof(int8_t) * count) * 2
+         + align_size(sizeof(uint16_t) * count)
+         + align_size(sizeof(uint32_t) * count) * 4
+         + align_size(sizeof(struct Rng) * count)
+         + align_size(sizeof(struct Randomizer) * count)
+         + align_size(sizeof(struct PieceQueue) * count);
+}
+
+void init_batch(struct BatchGames* batch, void* memory, int count, uint32_t seed, const struct GameConfig* config)
+{
+    const struct RuleSet* rules;
+    struct GameData game_data = init_gamedata_with_config(seed, config);
+    char* next = memory;
+
+    // the game only serves to apply the limits of the config and to pick a seed when 0 is given
+    batch->count = count;
+    batch->width = game_data.width;
+    batch->height = game_data.height;
+    batch->gravity_steps = 1;
+    batch->rule_set = get_rule_set(config, &rules);
+    batch->rules = *rules;
+    batch->config = *config;
+    batch->seed = game_data.seed;
+
+    batch->rows          = take_memory(&next, sizeof(arena_row_t) * count * batch->height);
+    batch->piece         = take_memory(&next, sizeof(uint8_t) * count);
+    batch->rotation      = take_memory(&next, sizeof(uint8_t) * count);
+    batch->position_x    = take_memory(&next, sizeof(int8_t) * count);
+    batch->position_y    = take_memory(&next, sizeof(int8_t) * count);
+    batch->gravity_timer = take_memory(&next, sizeof(uint16_t) * count);
+    batch->score         = take_memory(&next, sizeof(uint32_t) * count);
+    batch->cleared_lines = take_memory(&next, sizeof(uint32_t) * count);
+    batch->level         = take_memory(&next, sizeof(uint32_t) * count);
+    batch->episode       = take_memory(&next, sizeof(uint32_t) * count);
+    batch->rng           = take_memory(&next, sizeof(struct Rng) * count);
+    batch->randomizer    = take_memory(&next, sizeof(struct Randomizer) * count);
+    batch->preview       = take_memory(&next, sizeof(struct PieceQueue) * count);
+
+    for (int game = 0; game < count; game++) {
+        batch->episode[game] = 0;
+        batch_reset_game(batch, game);
+    }
+}
+
+/*
+    Helper function that takes the next piece from the preview of the game and puts it at the top of the arena.
+    Returns true when the new piece overlaps blocks of the arena (block out).
+*/
+static bool spawn_piece(struct BatchGames* batch, int game)
+{
+    enum Piece piece = piece_queue_pop(&batch->preview[game], &batch->randomizer[game], &batch->rng[game]);
+    const struct PieceShape* shape = get_piece_shape(piece, 0);
+
+    batch->piece[game] = piece;
+    batch->rotation[game] = 0;
+    batch->position_x[game] = START_POSITION_X(batch->width) - shape->min_x;
+    batch->position_y[game] = START_POSITION_Y - shape->min_y;
+    batch->gravity_timer[game] = 0;
+
+    return board_piece_collides(batch->rows + (size_t)game * batch->height, batch->width, batch->height,
+                                piece, 0, batch->position_x[game], batch->position_y[game]);
+}
+
+void batch_reset_game(struct BatchGames* batch, int game)
+{
+    uint64_t seed = ((uint64_t)batch->episode[game] << 32) | (uint32_t)(batch->seed + game);
+
+    rng_seed(&batch->rng[game], seed);
+    init_randomizer(&batch->randomizer[game], batch->config.randomizer);
+    init_piece_queue(&batch->preview[game], batch->config.preview_depth, &batch->randomizer[game], &batch->rng[game]);
+
+    memset(batch->rows + (size_t)game * batch->height, 0, sizeof(arena_row_t) * batch->height);
+    batch->score[game] = 0;
+    batch->cleared_lines[game] = 0;
+    batch->level[game] = batch->rules.first_level;
+
+    spawn_piece(batch, game);
+}
+
+/*
+    Helper function that writes the current piece of a game into its rows, removes the filled rows,
+    scores them and spawns the next piece.
+    Returns the points scored, is_defeat is set when the game is lost by the defeat rules of the config.
+*/
+BOARD_INLINE uint32_t lock_batch_piece(struct BatchGames* batch, int game, bool* is_defeat, const struct RuleSet* rules,
+                                       int width, int height)
+{
+    arena_row_t* rows = batch->rows + (size_t)game * height;
+    const struct PieceShape* shape = get_piece_shape(batch->piece[game], batch->rotation[game]);
+    int position_x = batch->position_x[game];
+    int top_row = batch->position_y[game] + shape->min_y;
+    int bottom_row = batch->position_y[game] + shape->max_y;
+
+    arena_row_t full_row = full_row_mask(width);
+    size_t cleared_rows = 0;
+    for (int y = shape->min_y; y <= shape->max_y; y++) {
+        int row = batch->position_y[game] + y;
+        if (row < 0) continue;
+
+        rows[row] |= shift_piece_row(shape->row_masks[y], position_x);
+        cleared_rows += rows[row] == full_row;
+    }
+
+    // move the remaining rows down over the filled ones, starting below the piece
+    if (cleared_rows > 0) {
+        int write = bottom_row;
+        for (int row = bottom_row; row >= 0; row--) {
+            if (rows[row] != full_row) rows[write--] = rows[row];
+        }
+        while (write >= 0) rows[write--] = 0;
+    }
+
+    uint32_t points = rules_line_score(rules, cleared_rows, batch->level[game]);
+    batch->score[game] += points;
+    batch->cleared_lines[game] += cleared_rows;
+    batch->level[game] = rules_level(rules, batch->cleared_lines[game]);
+
+    unsigned defeat_rules = batch->config.defeat_rules;
+    *is_defeat = ((defeat_rules & DEFEAT_LOCK_OUT) && bottom_row < SPAWN_ZONE_ROWS)
+              || ((defeat_rules & DEFEAT_PARTIAL_LOCK_OUT) && top_row < SPAWN_ZONE_ROWS);
+    *is_defeat |= spawn_piece(batch, game) && (defeat_rules & DEFEAT_BLOCK_OUT);
+
+    return points;
+}
+
+BOARD_INLINE void batch_step_sized(struct BatchGames* batch, const uint8_t* actions, float* rewards, uint8_t* dones,
+                                   const struct RuleSet* rules, int width, int height)
+{
+    for (int game = 0; game < batch->count; game++) {
+        const arena_row_t* rows = batch->rows + (size_t)game * height;
+        enum Piece piece = batch->piece[game];
+        int rotation = batch->rotation[game];
+        int position_x = batch->position_x[game];
+        int position_y = batch->position_y[game];
+        bool lock = false;
+
+        switch (actions[game]) {
+            case ACTION_LEFT:
+            case ACTION_RIGHT: {
+                int step = (actions[game] == ACTION_LEFT) ? -1 : 1;
+                if (!board_piece_collides(rows, width, height, piece, rotation, position_x + step, position_y)) position_x += step;
+                break;
+            }
+            case ACTION_ROTATE_RIGHT:
+            case ACTION_ROTATE_LEFT: {
+                bool clockwise = actions[game] == ACTION_ROTATE_RIGHT;
+                int new_rotation = (rotation + (clockwise ? 1 : PIECE_ROTATIONS - 1)) % PIECE_ROTATIONS;
+                const struct KickList* kicks = get_rotation_kicks(batch->config.rotation_system, piece, rotation, clockwise);
+
+                for (int i = 0; i < kicks->count; i++) {
+                    int kicked_x = position_x + kicks->offsets[i][0];
+                    int kicked_y = position_y + kicks->offsets[i][1];
+
+                    if (!board_piece_collides(rows, width, height, piece, new_rotation, kicked_x, kicked_y)) {
+                        rotation = new_rotation;
+                        position_x = kicked_x;
+                        position_y = kicked_y;
+                        break;
+                    }
+                }
+                break;
+            }
+            case ACTION_SOFT_DROP:
+                if (board_piece_collides(rows, width, height, piece, rotation, position_x, position_y + 1)) lock = true;
+                else position_y++;
+                break;
+            case ACTION_HARD_DROP:
+                while (!board_piece_collides(rows, width, height, piece, rotation, position_x, position_y + 1)) position_y++;
+                lock = true;
+                break;
+            default:
+                break;
+        }
+
+        // gravity
+        if (!lock && batch->gravity_steps > 0 && ++batch->gravity_timer[game] >= batch->gravity_steps) {
+            batch->gravity_timer[game] = 0;
+            if (board_piece_collides(rows, width, height, piece, rotation, position_x, position_y + 1)) lock = true;
+            else position_y++;
+        }
+
+        batch->rotation[game] = rotation;
+        batch->position_x[game] = position_x;
+        batch->position_y[game] = position_y;
+
+        bool is_defeat = false;
+        uint32_t points = lock ? lock_batch_piece(batch, game, &is_defeat, rules, width, height) : 0;
+
+        rewards[game] = (float)points;
+        dones[game] = is_defeat;
+        if (is_defeat) {
+            batch->episode[game]++;
+            batch_reset_game(batch, game);
+        }
+    }
+}
+
+BOARD_INLINE void batch_step_rules(struct BatchGames* batch, const uint8_t* actions, float* rewards, uint8_t* dones,
+                                   const struct RuleSet* rules)
+{
+    WITH_ARENA_SIZE(batch, batch_step_sized, batch, actions, rewards, dones, rules);
+}
+
+void batch_step(struct BatchGames* batch, const uint8_t* actions, float* rewards, uint8_t* dones)
+{
+    WITH_RULE_SET(batch, batch_step_rules, batch, actions, rewards, dones);
+}
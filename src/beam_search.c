@@ -0,0 +1,264 @@
+#include "beam_search.h"
+
+struct BeamConfig default_beam_config(void)
+{
+    struct BeamConfig config = {
+        .beam_width = 64,
+        .depth = 0,
+        .threads = 0,
+        .time_budget = 0.0,
+    };
+    for (int i = 0; i < EVAL_FEATURES; i++) config.weights[i] = EL_TETRIS_WEIGHTS[i];
+
+    return config;
+}
+
+bool init_beam_search(struct BeamSearch* search, const struct BeamConfig* config)
+{
+    search->config = *config;
+    if (search->config.beam_width < 1) search->config.beam_width = 1;
+    if (search->config.threads < 1) search->config.threads = get_processor_count();
+
+    // a pool that can't start every thread runs on the ones it got, the search is sized for those and not for the config
+    init_thread_pool(&search->pool, search->config.threads);
+    search->config.threads = search->pool.thread_count;
+
+    int width = search->config.beam_width;
+    int threads = search->config.threads;
+
+    init_evaluator(&search->evaluator, search->config.weights);
+
+    search->root_list = allocate_aligned(1, sizeof(struct PlacementList));
+    search->beam = allocate_aligned(width, sizeof(struct BeamNode));
+    search->next_beam = allocate_aligned(width, sizeof(struct BeamNode));
+    search->candidates = malloc(sizeof(struct BeamCandidate) * width * threads);
+    search->threads = allocate_aligned(threads, sizeof(struct BeamThread));
+    search->beam_count = 0;
+    search->candidate_count = 0;
+    search->depth_reached = 0;
+    search->nodes = 0;
+
+    bool allocated = search->root_list && search->beam && search->next_beam && search->candidates && search->threads;
+    if (search->threads != NULL) {
+        for (int thread = 0; thread < threads; thread++) {
+            search->threads[thread].best = malloc(sizeof(struct BeamCandidate) * width);
+            allocated &= search->threads[thread].best != NULL;
+        }
+    }
+    if (!allocated) {
+        destroy_beam_search(search);
+        return false;
+    }
+    return true;
+}
+
+void destroy_beam_search(struct BeamSearch* search)
+{
+    destroy_thread_pool(&search->pool);
+
+    if (search->threads != NULL) {
+        for (int thread = 0; thread < search->config.threads; thread++) free(search->threads[thread].best);
+    }
+    free(search->root_list);
+    free(search->beam);
+    free(search->next_beam);
+    free(search->candidates);
+    free(search->threads);
+}
+
+/*
+    Helper function that orders the candidates: a higher score comes first, equal scores are ordered
+    by parent and placement so that the selection never depends on the order the threads found them in.
+*/
+static bool better_candidate(const struct BeamCandidate* a, const struct BeamCandidate* b)
+{
+    if (a->score != b->score) return a->score > b->score;
+    if (a->parent != b->parent) return a->parent < b->parent;
+    return a->placement < b->placement;
+}
+
+static int compare_candidates(const void* a, const void* b)
+{
+    return better_candidate(a, b) ? -1 : better_candidate(b, a) ? 1 : 0;
+}
+
+static int compare_candidate_parents(const void* a, const void* b)
+{
+    const struct BeamCandidate* first = a;
+    const struct BeamCandidate* second = b;
+
+    if (first->parent != second->parent) return (first->parent < second->parent) ? -1 : 1;
+    return first->placement - second->placement;
+}
+
+/*
+    Helper function that offers a candidate to the best ones of a thread, a heap of at most capacity candidates
+    with the worst one at index 0.
+*/
+static void offer_candidate(struct BeamThread* thread, int capacity, struct BeamCandidate candidate)
+{
+    struct BeamCandidate* heap = thread->best;
+    int index;
+
+    if (thread->best_count < capacity) {
+        // sift the new candidate up from the end
+        index = thread->best_count++;
+        while (index > 0 && better_candidate(&heap[(index - 1) / 2], &candidate)) {
+            heap[index] = heap[(index - 1) / 2];
+            index = (index - 1) / 2;
+        }
+        heap[index] = candidate;
+        return;
+    }
+    if (!better_candidate(&candidate, &heap[0])) return;
+
+    // replace the worst candidate and sift down
+    index = 0;
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= capacity) break;
+        if (child + 1 < capacity && better_candidate(&heap[child], &heap[child + 1])) child++;
+        if (!better_candidate(&candidate, &heap[child])) break;
+
+        heap[index] = heap[child];
+        index = child;
+    }
+    heap[index] = candidate;
+}
+
+/*
+    Task of the threads: every thread expands every thread_count-th node of the beam and keeps its best children.
+*/
+static void expand_beam(void* context, int thread_index, int thread_count)
+{
+    struct BeamSearch* search = context;
+    struct BeamThread* thread = &search->threads[thread_index];
+    struct PlacementRatings* ratings = &thread->ratings;
+    int capacity = search->config.beam_width;
+    uint64_t nodes = 0;
+
+    thread->best_count = 0;
+
+    for (int parent = thread_index; parent < search->beam_count; parent += thread_count) {
+        const struct BeamNode* node = &search->beam[parent];
+        const struct GameData* game_data = &node->game_data;
+
+        if (node->score == -INFINITY) continue;
+
+        int count = generate_placements(game_data, &ratings->list);
+        for (int first = 0; first < count; first += EVAL_CHUNK) {
+            int chunk = (count - first < EVAL_CHUNK) ? count - first : EVAL_CHUNK;
+
+            rate_placements(&search->evaluator, game_data, &ratings->list, first, chunk, ratings);
+            for (int i = 0; i < chunk; i++) {
+                struct BeamCandidate candidate = { node->score + ratings->scores[i], parent, first + i };
+                offer_candidate(thread, capacity, candidate);
+            }
+            nodes += chunk;
+        }
+    }
+
+    thread->list_parent = -1;
+    __atomic_fetch_add(&search->nodes, nodes, __ATOMIC_RELAXED);
+}
+
+/*
+    Task of the threads: every thread plays a contiguous part of the selected children through the engine.
+    The children are sorted by parent, so the placements of a parent are mostly generated once per thread.
+*/
+static void play_candidates(void* context, int thread_index, int thread_count)
+{
+    struct BeamSearch* search = context;
+    struct BeamThread* thread = &search->threads[thread_index];
+    int first = search->candidate_count * thread_index / thread_count;
+    int last = search->candidate_count * (thread_index + 1) / thread_count;
+
+    for (int i = first; i < last; i++) {
+        const struct BeamCandidate* candidate = &search->candidates[i];
+        const struct BeamNode* parent = &search->beam[candidate->parent];
+        struct BeamNode* child = &search->next_beam[i];
+
+        if (thread->list_parent != candidate->parent) {
+            generate_placements(&parent->game_data, &thread->ratings.list);
+            thread->list_parent = candidate->parent;
+        }
+
+        gamedata_snapshot(&parent->game_data, &child->game_data);
+        play_placement(&child->game_data, &thread->ratings.list, candidate->placement);
+
+        child->score = child->game_data.is_defeat ? -INFINITY : candidate->score;
+        child->root = (search->depth == 0) ? candidate->placement : parent->root;
+    }
+}
+
+/*
+    Helper function that returns the seconds since an arbitrary point in time.
+*/
+static double get_seconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+int beam_search_best(struct BeamSearch* search, const struct GameData* game_data)
+{
+    double start = get_seconds();
+    int width = search->config.beam_width;
+    int depth = 1 + game_data->preview.depth;
+    if (search->config.depth > 0 && search->config.depth < depth) depth = search->config.depth;
+
+    search->depth_reached = 0;
+    search->nodes = 0;
+
+    if (game_data->is_defeat || generate_placements(game_data, search->root_list) == 0) return -1;
+
+    gamedata_snapshot(game_data, &search->beam[0].game_data);
+    search->beam[0].score = 0.0f;
+    search->beam[0].root = -1;
+    search->beam_count = 1;
+
+    for (search->depth = 0; search->depth < depth; search->depth++) {
+        thread_pool_run(&search->pool, expand_beam, search);
+
+        // the best children of all threads, the best width of them form the next beam
+        search->candidate_count = 0;
+        for (int thread = 0; thread < search->pool.thread_count; thread++) {
+            memcpy(search->candidates + search->candidate_count, search->threads[thread].best,
+                   sizeof(struct BeamCandidate) * search->threads[thread].best_count);
+            search->candidate_count += search->threads[thread].best_count;
+        }
+        if (search->candidate_count == 0) break;
+
+        qsort(search->candidates, search->candidate_count, sizeof(struct BeamCandidate), compare_candidates);
+        if (search->candidate_count > width) search->candidate_count = width;
+        qsort(search->candidates, search->candidate_count, sizeof(struct BeamCandidate), compare_candidate_parents);
+
+        thread_pool_run(&search->pool, play_candidates, search);
+
+        struct BeamNode* beam = search->beam;
+        search->beam = search->next_beam;
+        search->next_beam = beam;
+        search->beam_count = search->candidate_count;
+        search->depth_reached++;
+
+        if (search->config.time_budget > 0.0 && get_seconds() - start >= search->config.time_budget) break;
+    }
+
+    if (search->depth_reached == 0) return -1;
+
+    int best = 0;
+    for (int i = 1; i < search->beam_count; i++) {
+        if (search->beam[i].score > search->beam[best].score) best = i;
+    }
+    return search->beam[best].root;
+}
+
+bool beam_search_play(struct BeamSearch* search, struct GameData* game_data)
+{
+    int placement = beam_search_best(search, game_data);
+    if (placement < 0) return false;
+
+    play_placement(game_data, search->root_list, placement);
+    return true;
+}
@@ -3,228 +3,149 @@
 /*
     Helper funtions for getting the width of the matrix of a piece depending on its shape.
 */
-int get_piece_size(const int* piece)
+int get_piece_size(enum Piece piece)
 {
-    switch(piece[0]) {
-        case PIECE_O:
-            return 2;
-        case PIECE_L:
-        case PIECE_S:
-        case PIECE_T:
-        case PIECE_Z:
-        case PIECE_J:
-            return 3;
-        case PIECE_I:
-            return 4;
-        default:
-            dprintf(2, "Piece with unknown piece ID: %d!\n", piece[0]);
-            exit(-1);
-    };
+    return PIECE_SIZES[piece];
 }
 
+/*
+    Helper functions that move the piece up and to the left so that its top most row
+    and left most column of blocks start at the current position.
+*/
 void align_y(struct GameData* game_data) {
-    int size = get_piece_size(game_data->current_piece);
-    for (int y = 0; y < size; y++) {
-        for (int x = 0; x < size; x++) {
-            if (game_data->current_piece[coords_to_array_index(x, y, size) + 1] != 0) return;
-        }
-        game_data->position_y = game_data->position_y - 1;
-    }
+    game_data->position_y -= get_piece_shape(game_data->current_piece, game_data->rotation)->min_y;
 }
 
 void align_x(struct GameData* game_data) {
-    int size = get_piece_size(game_data->current_piece);
-    for (int x = 0; x < size; x++) {
-        for (int y = 0; y < size; y++) {
-            if (game_data->current_piece[coords_to_array_index(x, y, size) + 1] != 0) return;
-        }
-        game_data->position_x = game_data->position_x - 1;
-    }
+    game_data->position_x -= get_piece_shape(game_data->current_piece, game_data->rotation)->min_x;
 }
 
-struct GameData init_gamedata(uint32_t initial_seed)
+struct GameConfig default_game_config()
+{
+    return rule_set_config(RULES_CLASSIC);
+}
+
+struct GameConfig rule_set_config(enum RuleSetType rule_set)
 {
-    int* arena = (int*)calloc(sizeof(int), 10 * 20);
-    int* piece_count = (int*)calloc(sizeof(int), 7);
+    struct GameConfig config = {
+        .randomizer = RANDOMIZER_UNIFORM,
+        .preview_depth = 1,
+        .rotation_system = ROTATION_CLASSIC,
+        .defeat_rules = DEFEAT_BLOCK_OUT,
+        .width = ARENA_WIDTH,
+        .height = ARENA_HEIGHT,
+        .handling = {
+            .das = MOVE_SIDE_WAYS_TICKS,
+            .arr = MOVE_SIDE_WAYS_TICKS,
+            .soft_drop_factor = 20,
+            .lock_delay = 0,
+            .lock_resets = 15,
+        },
+        .rule_set = rule_set,
+        .custom_rules = NULL,
+    };
 
-    if (arena == NULL || piece_count == NULL) {
-        dprintf(2, "Couldn't allocate memory for the arena or the piece counter! Exiting...");
-        exit(ENOMEM);
+    switch (rule_set) {
+        case RULES_NES:
+            config.randomizer = RANDOMIZER_NES;
+            config.handling.das = 16;
+            config.handling.arr = 6;
+            config.handling.soft_drop_factor = 24;      // half a cell per frame at level 0
+            break;
+        case RULES_GUIDELINE:
+            config.randomizer = RANDOMIZER_BAG;
+            config.preview_depth = 5;
+            config.rotation_system = ROTATION_SRS;
+            config.defeat_rules = DEFEAT_BLOCK_OUT | DEFEAT_LOCK_OUT;
+            config.handling.das = 10;
+            config.handling.arr = 2;
+            config.handling.lock_delay = 30;
+            break;
+        default:
+            break;
     }
 
-    struct GameData gameData = {
-        .gameState = PLAYING,
-        .current_piece = NULL,
-        .next_piece = NULL,
-        .arena = arena,
-        .position_x = START_POSITION_X,
-        .position_y = START_POSITION_Y,
-        .fast_drop = false,
-        .score = 0,
-        .level = 0,
-        .piece_count = piece_count,
-        .accumulated_time = 0.0,
-        .is_defeat = false,
-        .seed = (initial_seed == 0) ? time(NULL) : initial_seed,    // <--- trailing comma from rust
-    };
+    return config;
+}
 
-    srand(gameData.seed);
+enum RuleSetType get_rule_set(const struct GameConfig* config, const struct RuleSet** rules)
+{
+    static const struct RuleSet* const BUILT_IN_RULES[RULE_SETS] = {
+        [RULES_CLASSIC]   = &CLASSIC_RULES,
+        [RULES_NES]       = &NES_RULES,
+        [RULES_GUIDELINE] = &GUIDELINE_RULES,
+    };
 
-    gameData.next_piece = generate_next_piece();
-    spawn_new_piece(&gameData);
+    if (config->rule_set == RULES_CUSTOM && config->custom_rules != NULL && rules_valid(config->custom_rules)) {
+        *rules = config->custom_rules;
+        return RULES_CUSTOM;
+    }
+    if (config->rule_set < 0 || config->rule_set >= RULE_SETS || BUILT_IN_RULES[config->rule_set] == NULL) {
+        *rules = &CLASSIC_RULES;
+        return RULES_CLASSIC;
+    }
 
-    return gameData;
+    *rules = BUILT_IN_RULES[config->rule_set];
+    return config->rule_set;
 }
 
-void free_gamedata(struct GameData *game_data)
+struct GameData init_gamedata(uint32_t initial_seed)
 {
-    free(game_data->arena);
-    if (game_data->current_piece != NULL) free(game_data->current_piece);
-    if (game_data->next_piece != NULL) free(game_data->next_piece);
-    free(game_data->piece_count);
+    struct GameConfig config = default_game_config();
+    return init_gamedata_with_config(initial_seed, &config);
 }
 
-int* generate_next_piece()
+/*
+    Helper function that limits value to the range [min, max].
+*/
+static int clamp(int value, int min, int max)
 {
-    int* new_piece;
-
-    switch (((uint32_t)(rand())) % 7)
-    {
-        case PIECE_O: {
-            new_piece = (int*)calloc(1 + 4, sizeof(int));
-            if (new_piece == NULL) goto ERROR_GEN_PIECE;
-
-            new_piece[0] = PIECE_O;
-            new_piece[1] = 1;
-            new_piece[2] = 1;
-            new_piece[3] = 1;
-            new_piece[4] = 1;
-
-            break;
-        }
-
-        case PIECE_L: {
-            new_piece = (int*)calloc(1 + 9, sizeof(int));
-            if (new_piece == NULL) goto ERROR_GEN_PIECE;
-
-            new_piece[0] = PIECE_L;
-            new_piece[1] = 0;
-            new_piece[2] = 2;
-            new_piece[3] = 0;
-            new_piece[4] = 0;
-            new_piece[5] = 2;
-            new_piece[6] = 0;
-            new_piece[7] = 0;
-            new_piece[8] = 2;
-            new_piece[9] = 2;
-
-            break;
-        }
-
-        case PIECE_J: {
-            new_piece = (int*)calloc(1 + 9, sizeof(int));
-            if (new_piece == NULL) goto ERROR_GEN_PIECE;
-
-            new_piece[0] = PIECE_J;
-            new_piece[1] = 0;
-            new_piece[2] = 3;
-            new_piece[3] = 0;
-            new_piece[4] = 0;
-            new_piece[5] = 3;
-            new_piece[6] = 0;
-            new_piece[7] = 3;
-            new_piece[8] = 3;
-            new_piece[9] = 0;
-
-            break;
-        }
-
-        case PIECE_T: {
-            new_piece = (int*)calloc(1 + 9, sizeof(int));
-            if (new_piece == NULL) goto ERROR_GEN_PIECE;
-
-            new_piece[0] = PIECE_T;
-            new_piece[1] = 0;
-            new_piece[2] = 0;
-            new_piece[3] = 0;
-            new_piece[4] = 4;
-            new_piece[5] = 4;
-            new_piece[6] = 4;
-            new_piece[7] = 0;
-            new_piece[8] = 4;
-            new_piece[9] = 0;
-
-            break;
-        }
+    return (value < min) ? min : (value > max) ? max : value;
+}
 
-        case PIECE_I: {
-            new_piece = (int*)calloc(1 + 16, sizeof(int));
-            if (new_piece == NULL) goto ERROR_GEN_PIECE;
-
-            new_piece[0] = PIECE_I;
-            new_piece[1] = 0;
-            new_piece[2] = 0;
-            new_piece[3] = 5;
-            new_piece[4] = 0;
-            new_piece[5] = 0;
-            new_piece[6] = 0;
-            new_piece[7] = 5;
-            new_piece[8] = 0;
-            new_piece[9] = 0;
-            new_piece[10] = 0;
-            new_piece[11] = 5;
-            new_piece[12] = 0;
-            new_piece[13] = 0;
-            new_piece[14] = 0;
-            new_piece[15] = 5;
-            new_piece[16] = 0;
+struct GameData init_gamedata_with_config(uint32_t initial_seed, const struct GameConfig* config)
+{
+    int width  = clamp(config->width,  ARENA_MIN_WIDTH,  ARENA_MAX_WIDTH);
+    int height = clamp(config->height, ARENA_MIN_HEIGHT, ARENA_MAX_HEIGHT);
 
-            break;
-        }
+    const struct RuleSet* rules;
+    enum RuleSetType rule_set = get_rule_set(config, &rules);
 
-        case PIECE_Z: {
-            new_piece = (int*)calloc(1 + 9, sizeof(int));
-            if (new_piece == NULL) goto ERROR_GEN_PIECE;
-
-            new_piece[0] = PIECE_Z;
-            new_piece[1] = 0;
-            new_piece[2] = 0;
-            new_piece[3] = 0;
-            new_piece[4] = 6;
-            new_piece[5] = 6;
-            new_piece[6] = 0;
-            new_piece[7] = 0;
-            new_piece[8] = 6;
-            new_piece[9] = 6;
-            break;
-        }
-
-        case PIECE_S: {
-            new_piece = (int*)calloc(1 + 9, sizeof(int));
-            if (new_piece == NULL) goto ERROR_GEN_PIECE;
-
-            new_piece[0] = PIECE_S;
-            new_piece[1] = 0;
-            new_piece[2] = 0;
-            new_piece[3] = 0;
-            new_piece[4] = 0;
-            new_piece[5] = 7;
-            new_piece[6] = 7;
-            new_piece[7] = 7;
-            new_piece[8] = 7;
-            new_piece[9] = 0;
-            break;
-        }
+    struct GameData gameData = {
+        .gameState = PLAYING,
+        .current_piece = PIECE_O,
+        .rotation = 0,
+        .width = width,
+        .height = height,
+        .arena = { 0 },
+        .arena_rows = { 0 },
+        .features = { .column_masks = { 0 } },
+        .position_x = START_POSITION_X(width),
+        .position_y = START_POSITION_Y,
+        .fast_drop = false,
+        .score = 0,
+        .level = rules->first_level,
+        .piece_count = { 0 },
+        .accumulated_time = 0.0,
+        .ticks = { 0 },
+        .handling = config->handling,
+        .rule_set = rule_set,
+        .rules = *rules,
+        .is_defeat = false,
+        .defeat_rules = config->defeat_rules,
+        .last_lock_rows = 0,
+        .arena_hash = 0,
+        .rotation_system = config->rotation_system,
+        .seed = (initial_seed == 0) ? time(NULL) : initial_seed,    // <--- trailing comma from rust
+    };
 
-        default:
-            exit(-1);
-    }
+    rng_seed(&gameData.rng, gameData.seed);
 
-    return new_piece;
+    init_randomizer(&gameData.randomizer, config->randomizer);
+    init_piece_queue(&gameData.preview, config->preview_depth, &gameData.randomizer, &gameData.rng);
+    spawn_new_piece(&gameData);
 
-ERROR_GEN_PIECE:
-    dprintf(2, "Couldn't allocate memory for the next tetris piece! Exiting...");
-    exit(ENOMEM);
+    return gameData;
 }
 
 void array_index_to_coords(size_t index, size_t width, size_t* x, size_t* y)
@@ -242,201 +163,287 @@ size_t coords_to_array_index(size_t x, size_t y, size_t width)
 
 bool check_collision_arena_wall(const struct GameData* game_data)
 {
-    // find the left most non zero entry in the matrix
-    int size = get_piece_size(game_data->current_piece);
-    int non_zero_index_left = 0;
-    for (int x = 0; x < size; x++) {
-        for (int y = 0; y < size; y++) {
-            if (game_data->current_piece[coords_to_array_index(x, y, size) + 1] != 0) {
-                non_zero_index_left = x;
-                goto LOOP_END1;
-            }
-        }
-    }
-LOOP_END1:;
-
-    // find the right most non zero entry in the matrix
-    int non_zero_index_right = 0;
-    for (int x = size - 1; x >= 0; x--) {
-        for (int y = 0; y < size; y++) {
-            if (game_data->current_piece[coords_to_array_index(x, y, size) + 1] != 0) {
-                non_zero_index_right = x;
-                goto LOOP_END2;
-            }
-        }
-    }
-LOOP_END2:;
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, game_data->rotation);
+    return !board_piece_inside_walls(shape, game_data->position_x, game_data->width);
+}
 
-    // check if the left most and right most entries are in bounds of the arena
-    return non_zero_index_left + game_data->position_x < 0 || non_zero_index_right + game_data->position_x >= ARENA_WIDTH;
+BOARD_INLINE bool piece_collides_sized(const struct GameData* game_data, enum Piece piece, int rotation, int position_x, int position_y,
+                                      int width, int height)
+{
+    return board_piece_collides(game_data->arena_rows, width, height, piece, rotation, position_x, position_y);
+}
+
+bool piece_collides(const struct GameData* game_data, enum Piece piece, int rotation, int position_x, int position_y)
+{
+    return WITH_ARENA_SIZE(game_data, piece_collides_sized, game_data, piece, rotation, position_x, position_y);
 }
 
 // TODO: if problems move bottom check to separate function
 bool check_collision_arena_pieces(const struct GameData* game_data)
 {
-    int size = get_piece_size(game_data->current_piece);
-
-    for (int y = 0; y < size; y++) {
-        for (int x = 0; x < size; x++) {
-            if (x + game_data->position_x >= ARENA_WIDTH) continue;
-
-            if (game_data->current_piece[coords_to_array_index(x, y, size) + 1] != 0
-            && (game_data->position_y + y >= ARENA_HEIGHT || game_data->arena[COORDS_TO_ARENA_INDEX(game_data->position_x + x, game_data->position_y + y)] != 0)) return true;
-        }
-    }
-    return false;
+    // one shifted row mask per piece row, specialized for the standard arena; the piece is always inside the walls
+    // when it falls, so the wall test of piece_collides doesn't change the result
+    return piece_collides(game_data, game_data->current_piece, game_data->rotation, game_data->position_x, game_data->position_y);
 }
 
 bool check_collision_side(const struct GameData* game_data)
 {
     // combine checks for piece and arena collision when moving side-to-side
-    return check_collision_arena_wall(game_data) || check_collision_arena_pieces(game_data);
+    return piece_collides(game_data, game_data->current_piece, game_data->rotation, game_data->position_x, game_data->position_y);
 }
 
-/*
-    Helper function for rotation a piece right once.
-    This is done by first transposing the matrix of the piece and then reversing the rows.
-*/
-void rotate_piece_right(int** piece)
+uint64_t calc_gamedata_hash(const struct GameData* game_data)
 {
-    // the O piece does not change when rotated by 90 degrees
-    if ((*piece)[0] == PIECE_O) return;
-
-    size_t size = get_piece_size(*piece);
-
-    // buffer for the rotated piece
-    int* buffer = (int*)calloc(sizeof(int), 1 + size * size);
-
-    buffer[0] = (*piece)[0];
-    for (size_t j = 0; j < size; j++) {
-        for (size_t i = 0; i < size; i++) {
-            // transpose a_ij => a_ji
-            // rev rows  a_ij => a_(size-1-i)j
-            // together  a_ij => a_(size-1-j)i
-            size_t from_index = coords_to_array_index(i, j, size) + 1;
-            size_t to_index   = coords_to_array_index(size - 1 -j, i, size) + 1;
-            buffer[to_index] = (*piece)[from_index];
-        }
-    }
+    uint64_t hash = zobrist_piece_key(game_data->current_piece, game_data->rotation, game_data->position_x, game_data->position_y);
+    for (int y = 0; y < game_data->height; y++) hash ^= zobrist_row_key(y, game_data->arena_rows[y]);
 
-    free(*piece);
-    *piece = buffer;
+    return hash;
 }
 
-void rotate_piece_left(int** piece) {
-    rotate_piece_right(piece);       // cool trick to save some code
-    rotate_piece_right(piece);       // 3 right rotations == 1 left rotation
-    rotate_piece_right(piece);       // look group theory
+/*
+    Helper function that combines the arena hash with the key of the current piece after it was replaced or rotated.
+*/
+static void update_piece_hash(struct GameData* game_data)
+{
+    game_data->hash = game_data->arena_hash
+        ^ zobrist_piece_key(game_data->current_piece, game_data->rotation, game_data->position_x, game_data->position_y);
 }
 
 void rotate_piece(struct GameData* game_data, enum Direction dir) {
-    if (dir == RIGHT)     rotate_piece_right(&game_data->current_piece);
-    else if (dir == LEFT) rotate_piece_left(&game_data->current_piece);
-
-    // if a collision occurs rotate back
-    if (check_collision_arena_pieces(game_data) || check_collision_arena_wall(game_data)) {
-        if (dir == LEFT)     rotate_piece_right(&game_data->current_piece);
-        else if (dir == RIGHT) rotate_piece_left(&game_data->current_piece);
+    int rotation = (game_data->rotation + ((dir == RIGHT) ? 1 : PIECE_ROTATIONS - 1)) % PIECE_ROTATIONS;
+    const struct KickList* kicks = get_rotation_kicks(game_data->rotation_system, game_data->current_piece, game_data->rotation, dir == RIGHT);
+
+    // take the first kick where the rotated piece fits, otherwise the rotation fails
+    for (int i = 0; i < kicks->count; i++) {
+        int position_x = game_data->position_x + kicks->offsets[i][0];
+        int position_y = game_data->position_y + kicks->offsets[i][1];
+
+        if (!piece_collides(game_data, game_data->current_piece, rotation, position_x, position_y)) {
+            game_data->rotation = rotation;
+            game_data->position_x = position_x;
+            game_data->position_y = position_y;
+            update_piece_hash(game_data);
+            return;
+        }
     }
 }
 
 void spawn_new_piece(struct GameData* game_data)
 {
-    if (game_data->current_piece != NULL) free(game_data->current_piece);
-    game_data->current_piece = game_data->next_piece;
-    game_data->next_piece = generate_next_piece();
+    game_data->current_piece = piece_queue_pop(&game_data->preview, &game_data->randomizer, &game_data->rng);
+    game_data->rotation = 0;
 
-    game_data->position_x = START_POSITION_X;
+    game_data->position_x = START_POSITION_X(game_data->width);
     game_data->position_y = START_POSITION_Y;
 
     align_y(game_data);
     align_x(game_data);
+    update_piece_hash(game_data);
 
-    game_data->piece_count[game_data->current_piece[0]]++;
+    game_data->piece_count[game_data->current_piece]++;
 
-    if (check_collision_arena_pieces(game_data)) game_data->is_defeat = true;
+    check_defeat(game_data);
 }
 
-/*
-    Helper functions that writes the current piece to the correct spot into the arena.
-*/
-void write_piece_to_arena(struct GameData* game_data)
+bool check_defeat(struct GameData* game_data)
 {
-    int size = get_piece_size(game_data->current_piece);
-    for (int y = 0; y < size; y++) {
-        if (y + game_data->position_y >= ARENA_HEIGHT) continue;
-        for (int x = 0; x < size; x++) {
-            if (x + game_data->position_x >= ARENA_WIDTH) continue;
-            game_data->arena[COORDS_TO_ARENA_INDEX(game_data->position_x + x, game_data->position_y + y)]
-                += game_data->current_piece[coords_to_array_index(x, y, size) + 1];
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, game_data->rotation);
+    unsigned rules = game_data->defeat_rules;
+    bool defeat = false;
+
+    // block out: the spawned piece overlaps the top rows of the arena
+    if (rules & DEFEAT_BLOCK_OUT) {
+        for (int y = shape->min_y; y <= shape->max_y; y++) {
+            int row = game_data->position_y + y;
+            if (row < 0) continue;
+
+            defeat |= (game_data->arena_rows[row] & shift_piece_row(shape->row_masks[y], game_data->position_x)) != 0;
         }
     }
+
+    // lock out: the last locked piece has no block below the spawn zone
+    if (rules & DEFEAT_LOCK_OUT)         defeat |= game_data->last_lock_rows != 0 && (game_data->last_lock_rows & ~SPAWN_ZONE_MASK) == 0;
+
+    // partial lock out: the last locked piece has a block in the spawn zone
+    if (rules & DEFEAT_PARTIAL_LOCK_OUT) defeat |= (game_data->last_lock_rows & SPAWN_ZONE_MASK) != 0;
+
+    game_data->is_defeat |= defeat;
+    return game_data->is_defeat;
 }
 
 /*
-    Helper functions that checks for filled rows, deletes them and adds to the score
-    depending on the number of simultanious rows cleared and the current level.
+    Helper function that derives the height and holes of the columns first_column to last_column
+    from their masks, and then refreshes the surface features which depend on the neighbouring columns.
+*/
+BOARD_INLINE void update_column_features_sized(struct BoardFeatures* features, int first_column, int last_column,
+                                               int width, int height)
+{
+    for (int x = first_column; x <= last_column; x++) {
+        uint32_t mask = features->column_masks[x];
+        int column_height = (mask == 0) ? 0 : 32 - __builtin_clz(mask);
 
-    returns the number of cleared lines
+        features->aggregate_height += column_height - features->column_heights[x];
+        features->holes += (column_height - __builtin_popcount(mask)) - features->column_holes[x];
+
+        features->column_heights[x] = column_height;
+        features->column_holes[x] = column_height - __builtin_popcount(mask);
+    }
+
+    // bumpiness and wells depend on the neighbours, summing them over the column heights is cheaper than tracking them
+    features->max_height = 0;
+    features->bumpiness = 0;
+    features->wells = 0;
+    for (int x = 0; x < width; x++) {
+        int column_height = features->column_heights[x];
+        int left   = (x == 0) ? height : features->column_heights[x - 1];
+        int right  = (x == width - 1) ? height : features->column_heights[x + 1];
+        int lower_neighbour = (left < right) ? left : right;
+
+        features->well_depths[x] = (lower_neighbour > column_height) ? lower_neighbour - column_height : 0;
+        features->wells += features->well_depths[x];
+
+        if (column_height > features->max_height) features->max_height = column_height;
+        if (x > 0) features->bumpiness += abs(column_height - left);
+    }
+}
+
+BOARD_INLINE void write_piece_to_arena_sized(struct GameData* game_data, int width, int height)
+{
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, game_data->rotation);
+    for (int y = shape->min_y; y <= shape->max_y; y++) {
+        if (y + game_data->position_y < 0 || y + game_data->position_y >= height) continue;
+
+        game_data->arena_rows[game_data->position_y + y] |= shift_piece_row(shape->row_masks[y], game_data->position_x);
+    }
+
+    for (int i = 0; i < PIECE_BLOCKS; i++) {
+        int x = game_data->position_x + shape->cells[i][0];
+        int y = game_data->position_y + shape->cells[i][1];
+        if (x < 0 || x >= width || y < 0 || y >= height) continue;
+
+        game_data->arena[coords_to_array_index(x, y, width)] = get_piece_block_id(game_data->current_piece);
+        game_data->arena_hash ^= zobrist_cell_key(x, y);
+        game_data->features.column_masks[x] |= 1u << (height - 1 - y);
+        game_data->features.row_fill[y]++;
+    }
+
+    // the rows of the piece as one mask for the lock out rules, rows above the arena count as the top row
+    int top_row = game_data->position_y + shape->min_y;
+    int bottom_row = game_data->position_y + shape->max_y;
+    if (top_row < 0) top_row = 0;
+    game_data->last_lock_rows = (bottom_row < 0) ? 1 : ((2u << bottom_row) - 1) & ~((1u << top_row) - 1);
+
+    int first_column = game_data->position_x + shape->min_x;
+    int last_column  = game_data->position_x + shape->max_x;
+    update_column_features_sized(&game_data->features, first_column, last_column, width, height);
+}
+
+/*
+    Helper functions that writes the current piece to the correct spot into the arena.
+    The bitboard receives the occupancy and the color plane the piece id for rendering.
 */
-size_t check_filled_rows(struct GameData* game_data)
+void write_piece_to_arena(struct GameData* game_data)
 {
-    // find the indecies of filled rows (which can be at most 4) from bottom to top
-    int row_buffer[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    if (IS_STANDARD_ARENA(game_data)) write_piece_to_arena_sized(game_data, ARENA_WIDTH, ARENA_HEIGHT);
+    else                              write_piece_to_arena_sized(game_data, game_data->width, game_data->height);
+}
+
+BOARD_INLINE size_t check_filled_rows_sized(struct GameData* game_data, int first_row, int last_row, const struct RuleSet* rules,
+                                            int width, int height)
+{
+    if (first_row < 0) first_row = 0;
+    if (last_row >= height) last_row = height - 1;
+
+    // find the indecies of filled rows (which can be at most 4) from top to bottom
+    arena_row_t full_row = full_row_mask(width);
+    int row_buffer[4];
     size_t buffer_index = 0;
-    for (int row = ARENA_HEIGHT - 1; row >= 0; row--) {
-        for (int x = 0; x < ARENA_WIDTH; x++) {
-            if (game_data->arena[COORDS_TO_ARENA_INDEX(x, row)] == 0) break;
-            if (x == ARENA_WIDTH - 1) row_buffer[buffer_index++] = row;
-        }
+    for (int row = first_row; row <= last_row; row++) {
+        if (game_data->arena_rows[row] == full_row) row_buffer[buffer_index++] = row;
     }
 
-    // single:   40 pts
-    // double:  100 pts
-    // triple:  300 pts
-    // tetris: 1200 pts
-    switch (buffer_index) {
-        case 0: return 0; // no rows cleared
-        case 1: game_data->score += 40 * (game_data->level + 1);
-                break;
-        case 2: game_data->score += 100 * (game_data->level + 1);
-                break;
-        case 3: game_data->score += 300 * (game_data->level + 1);
-                break;
-        case 4: game_data->score += 1200 * (game_data->level + 1);
-                break;
-    }
+    if (buffer_index == 0) return 0;
+    game_data->score += rules_line_score(rules, buffer_index, game_data->level);
 
-    // copy the not cleared rows into an arena buffer skipping the cleared ones
-    int* new_arena = (int*)calloc(sizeof(int), ARENA_WIDTH * ARENA_HEIGHT);
-    size_t current_row_index = ARENA_HEIGHT - 1;
-    buffer_index = 0;
-    for (int row = ARENA_HEIGHT - 1; row >= 0; row--) {
-        if (row == row_buffer[buffer_index]) {
-            buffer_index++;
-            continue;
+    // remove the cleared rows in place by moving every row above them down by one,
+    // starting with the top most one so that the indices of the rows below stay valid
+    struct BoardFeatures* features = &game_data->features;
+    for (size_t i = 0; i < buffer_index; i++) {
+        int row = row_buffer[i];
+
+        // every occupied cell above the row moves down by one, which changes its key
+        game_data->arena_hash ^= zobrist_row_key(row, game_data->arena_rows[row]);
+        for (int y = 0; y < row; y++) {
+            arena_row_t bits = game_data->arena_rows[y];
+            if (bits != 0) game_data->arena_hash ^= zobrist_row_key(y, bits) ^ zobrist_row_key(y + 1, bits);
         }
 
-        memcpy(new_arena + ARENA_WIDTH * current_row_index, game_data->arena + ARENA_WIDTH * row, sizeof(int) * ARENA_WIDTH);
-        current_row_index--;
+        memmove(game_data->arena_rows + 1, game_data->arena_rows, sizeof(game_data->arena_rows[0]) * row);
+        memmove(game_data->arena + width, game_data->arena, sizeof(game_data->arena[0]) * width * row);
+        memmove(features->row_fill + 1, features->row_fill, sizeof(features->row_fill[0]) * row);
+
+        game_data->arena_rows[0] = 0;
+        memset(game_data->arena, 0, sizeof(game_data->arena[0]) * width);
+        features->row_fill[0] = 0;
+
+        // in the column masks the row is a single bit, the bits above it move down by one
+        int bit = height - 1 - row;
+        uint32_t below = (1u << bit) - 1;
+        for (int x = 0; x < width; x++) {
+            uint32_t mask = features->column_masks[x];
+            features->column_masks[x] = (mask & below) | ((mask >> 1) & ~below);
+        }
     }
 
-    // swap the buffers and free the old arena
-    free(game_data->arena);
-    game_data->arena = new_arena;
+    update_column_features_sized(features, 0, width - 1, width, height);
 
     return buffer_index;
 }
 
+/*
+    Helper functions that checks for filled rows, deletes them and adds to the score
+    depending on the number of simultanious rows cleared, the current level and the rule set.
+    Only the rows first_row to last_row are checked, which are the rows the last locked piece touched.
+
+    returns the number of cleared lines
+*/
+BOARD_INLINE size_t check_filled_rows_rules(struct GameData* game_data, int first_row, int last_row, const struct RuleSet* rules)
+{
+    return WITH_ARENA_SIZE(game_data, check_filled_rows_sized, game_data, first_row, last_row, rules);
+}
+
 void move(struct GameData* game_data, enum Direction dir)
 {
+    int position_x = game_data->position_x;
+
     game_data->position_x += (dir == LEFT) ? -1 : 1;
     if (check_collision_side(game_data)) game_data->position_x -= (dir == LEFT) ? -1 : 1;
+
+    if (game_data->position_x != position_x) {
+        game_data->hash ^= zobrist_key(ZOBRIST_X, position_x) ^ zobrist_key(ZOBRIST_X, game_data->position_x);
+    }
 }
 
-void level_up(struct GameData* game_data)
+BOARD_INLINE size_t lock_piece_rules(struct GameData* game_data, const struct RuleSet* rules)
 {
-    game_data->level = game_data->cleared_lines / 10;
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, game_data->rotation);
+
+    write_piece_to_arena(game_data);
+    size_t rows = check_filled_rows_rules(game_data, game_data->position_y + shape->min_y, game_data->position_y + shape->max_y, rules);
+    game_data->cleared_lines += rows;
+    spawn_new_piece(game_data);
+    game_data->level = rules_level(rules, game_data->cleared_lines);
+
+    return rows;
+}
+
+/*
+    Helper function that writes the current piece into the arena, removes filled rows,
+    and spawns the next piece. Returns the number of cleared rows.
+*/
+static size_t lock_piece(struct GameData* game_data)
+{
+    return WITH_RULE_SET(game_data, lock_piece_rules, game_data);
 }
 
 size_t drop(struct GameData* game_data)
@@ -446,32 +453,86 @@ size_t drop(struct GameData* game_data)
 
     if (check_collision_arena_pieces(game_data)) {
         game_data->position_y--;
-
-        write_piece_to_arena(game_data);
-        rows = check_filled_rows(game_data);
-        game_data->cleared_lines += rows;
-        spawn_new_piece(game_data);
-        level_up(game_data);
+        rows = lock_piece(game_data);
+    }
+    else {
+        game_data->hash ^= zobrist_key(ZOBRIST_Y, game_data->position_y - 1) ^ zobrist_key(ZOBRIST_Y, game_data->position_y);
     }
 
     return rows;
 }
 
+int fall(struct GameData* game_data, int rows)
+{
+    int distance = get_ghost_row(game_data) - game_data->position_y;
+    if (rows > distance) rows = distance;
+    if (rows <= 0) return 0;
+
+    game_data->hash ^= zobrist_key(ZOBRIST_Y, game_data->position_y) ^ zobrist_key(ZOBRIST_Y, game_data->position_y + rows);
+    game_data->position_y += rows;
+
+    return rows;
+}
+
+size_t hard_drop(struct GameData* game_data)
+{
+    game_data->position_y = get_ghost_row(game_data);
+    return lock_piece(game_data);
+}
+
+BOARD_INLINE int get_ghost_row_sized(const struct GameData* game_data, int width, int height)
+{
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, game_data->rotation);
+
+    // the lowest block of every column of the piece has to stay above the top most block of that arena column
+    int landing_row = height;
+    for (int x = shape->min_x; x <= shape->max_x; x++) {
+        int column = game_data->position_x + x;
+        int row = height - game_data->features.column_heights[column] - 1 - shape->column_bottoms[x];
+        if (row < landing_row) landing_row = row;
+    }
+
+    // above the surface nothing can be in the way, so the piece falls down to the landing row
+    if (game_data->position_y <= landing_row) return landing_row;
+
+    // the piece is tucked below an overhang, the column heights don't tell where it lands
+    int position_y = game_data->position_y;
+    while (!board_piece_collides(game_data->arena_rows, width, height, game_data->current_piece, game_data->rotation,
+                                 game_data->position_x, position_y + 1)) position_y++;
+
+    return position_y;
+}
+
+int get_ghost_row(const struct GameData* game_data)
+{
+    return WITH_ARENA_SIZE(game_data, get_ghost_row_sized, game_data);
+}
+
 void generate_block_positions(const struct GameData* game_data, int* block_positions)
 {
     if (block_positions == NULL) return;
 
     // copy in the arena pieces
-    memcpy(block_positions, game_data->arena, sizeof(int) * ARENA_WIDTH * ARENA_HEIGHT);
+    for (int i = 0; i < game_data->width * game_data->height; i++) block_positions[i] = game_data->arena[i];
 
-    int size = get_piece_size(game_data->current_piece);
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, game_data->rotation);
 
-    // place the current piece into the buffer at the correct location
-    // this has to be done with the plus operation so that no other pieces are
-    // overwritten by the zeros in the piece matrix
-    for (int y = 0; y < size; y++)
-        for (int x = 0; x < size; x++) {
-            block_positions[COORDS_TO_ARENA_INDEX(game_data->position_x + x, game_data->position_y + y)] +=
-                game_data->current_piece[coords_to_array_index(x, y, size) + 1];
-        }
-}
+    // place the ghost piece where the current piece would land, the current piece is drawn over it
+    int ghost_row = get_ghost_row(game_data);
+    for (int i = 0; i < PIECE_BLOCKS; i++) {
+        int x = game_data->position_x + shape->cells[i][0];
+        int y = ghost_row + shape->cells[i][1];
+        if (x < 0 || x >= game_data->width || y < 0 || y >= game_data->height) continue;
+
+        block_positions[COORDS_TO_ARENA_INDEX(game_data, x, y)] = -get_piece_block_id(game_data->current_piece);
+    }
+
+    // place the blocks of the current piece into the buffer at the correct location
+    for (int i = 0; i < PIECE_BLOCKS; i++) {
+        int x = game_data->position_x + shape->cells[i][0];
+        int y = game_data->position_y + shape->cells[i][1];
+        if (x < 0 || x >= game_data->width || y < 0 || y >= game_data->height) continue;
+
+        block_positions[COORDS_TO_ARENA_INDEX(game_data, x, y)] = get_piece_block_id(game_data->current_piece);
+    }
+}
\ No newline at end of file
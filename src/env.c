@@ -0,0 +1,107 @@
+#include "env.h"
+
+int env_api_version(void)
+{
+    return ENV_API_VERSION;
+}
+
+size_t env_size(void)
+{
+    return sizeof(struct Env);
+}
+
+void env_create(struct Env* env, uint32_t seed, const struct GameConfig* config)
+{
+    env->config = (config == NULL) ? default_game_config() : *config;
+    env->episode = 0;
+    env->gravity_steps = 1;
+
+    env->game_data = init_gamedata_with_config(seed, &env->config);
+    env->seed = env->game_data.seed;
+    env->gravity_timer = 0;
+}
+
+void env_reset(struct Env* env, uint32_t seed)
+{
+    // skip 0, it would make init_gamedata pick a seed from the clock
+    if (seed == 0) seed = (env->seed == UINT32_MAX) ? 1 : env->seed + 1;
+
+    env->game_data = init_gamedata_with_config(seed, &env->config);
+    env->seed = seed;
+    env->episode++;
+    env->gravity_timer = 0;
+}
+
+/*
+    Helper function that moves the current piece down by one row or locks it when it rests on the ground.
+    Returns true when the piece was locked.
+*/
+static bool step_down(struct GameData* game_data)
+{
+    bool grounded = piece_collides(game_data, game_data->current_piece, game_data->rotation,
+                                   game_data->position_x, game_data->position_y + 1);
+    drop(game_data);
+    return grounded;
+}
+
+bool env_step(struct Env* env, int action, float* reward)
+{
+    struct GameData* game_data = &env->game_data;
+    uint32_t score = game_data->score;
+    bool locked = false;
+
+    if (game_data->is_defeat) {
+        if (reward != NULL) *reward = 0.0f;
+        return true;
+    }
+
+    switch (action) {
+        case ACTION_LEFT:         move(game_data, LEFT); break;
+        case ACTION_RIGHT:        move(game_data, RIGHT); break;
+        case ACTION_ROTATE_RIGHT: rotate_piece(game_data, RIGHT); break;
+        case ACTION_ROTATE_LEFT:  rotate_piece(game_data, LEFT); break;
+        case ACTION_SOFT_DROP:    locked = step_down(game_data); break;
+        case ACTION_HARD_DROP:    hard_drop(game_data); locked = true; break;
+        default: break;
+    }
+
+    if (locked) {
+        env->gravity_timer = 0;
+    }
+    else if (env->gravity_steps > 0 && ++env->gravity_timer >= env->gravity_steps) {
+        env->gravity_timer = 0;
+        step_down(game_data);
+    }
+
+    if (reward != NULL) *reward = (float)(game_data->score - score);
+    return game_data->is_defeat;
+}
+
+size_t env_observation_size(const struct Env* env)
+{
+    const struct GameData* game_data = &env->game_data;
+    return (size_t)game_data->width * game_data->height + 1 + game_data->preview.depth;
+}
+
+void env_observe(const struct Env* env, uint8_t* buffer)
+{
+    const struct GameData* game_data = &env->game_data;
+    int width = game_data->width;
+    int height = game_data->height;
+
+    for (int y = 0; y < height; y++) {
+        arena_row_t row = game_data->arena_rows[y];
+        for (int x = 0; x < width; x++) buffer[y * width + x] = (row >> x) & 1;
+    }
+
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, game_data->rotation);
+    for (int i = 0; i < PIECE_BLOCKS; i++) {
+        int x = game_data->position_x + shape->cells[i][0];
+        int y = game_data->position_y + shape->cells[i][1];
+        if (y >= 0) buffer[y * width + x] = 2;
+    }
+
+    uint8_t* pieces = buffer + width * height;
+    pieces[0] = game_data->current_piece;
+    for (int i = 0; i < game_data->preview.depth; i++) pieces[i + 1] = get_next_piece(game_data, i);
+}
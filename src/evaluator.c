@@ -0,0 +1,331 @@
+#include "evaluator.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define EVAL_X86
+#endif
+
+/*
+    All kernels walk the rows from top to bottom and count the features with bit operations on whole rows:
+        covered     the columns with a block in this row or above, so covered & ~row are the holes of the row,
+                    its population is the part of the aggregate height in this row and covered ^ (covered >> 1)
+                    marks the neighbouring columns of which only one reaches this row (bumpiness)
+        wells       empty cells with filled neighbours, runs[k] are the well cells with k more well cells above them,
+                    so adding the populations of all runs counts a well of depth d as 1 + 2 + ... + d
+*/
+
+void init_evaluator(struct Evaluator* evaluator, const float* weights)
+{
+    for (int i = 0; i < EVAL_FEATURES; i++) evaluator->weights[i] = weights[i];
+
+    evaluator->kernel = eval_kernel_supported(EVAL_KERNEL_AVX2) ? EVAL_KERNEL_AVX2
+                      : eval_kernel_supported(EVAL_KERNEL_SSE2) ? EVAL_KERNEL_SSE2
+                      : EVAL_KERNEL_SCALAR;
+}
+
+bool eval_kernel_supported(enum EvalKernel kernel)
+{
+    switch (kernel) {
+        case EVAL_KERNEL_SCALAR: return true;
+#ifdef EVAL_X86
+        case EVAL_KERNEL_SSE2: return __builtin_cpu_supports("sse2");
+        case EVAL_KERNEL_AVX2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+int eroded_piece_cells(const arena_row_t* rows, int width, enum Piece piece, int rotation, int position_x, int position_y)
+{
+    const struct PieceShape* shape = get_piece_shape(piece, rotation);
+    int cleared_rows = 0;
+    int cells = 0;
+
+    for (int y = shape->min_y; y <= shape->max_y; y++) {
+        int row = position_y + y;
+        if (row < 0) continue;
+
+        arena_row_t piece_row = shift_piece_row(shape->row_masks[y], position_x);
+        if ((rows[row] | piece_row) == full_row_mask(width)) {
+            cleared_rows++;
+            cells += __builtin_popcountll(piece_row);
+        }
+    }
+    return cleared_rows * cells;
+}
+
+/*
+    Helper function that combines the features of a board with the weights.
+*/
+static float weigh_features(const struct Evaluator* evaluator, const int64_t* features, const float* landing_heights,
+                            const uint8_t* eroded_cells, int board)
+{
+    const float* weights = evaluator->weights;
+    float score = 0.0f;
+
+    for (int i = EVAL_ROW_TRANSITIONS; i < EVAL_FEATURES; i++) score += weights[i] * (float)features[i];
+    if (landing_heights != NULL) score += weights[EVAL_LANDING_HEIGHT] * landing_heights[board];
+    if (eroded_cells != NULL) score += weights[EVAL_ERODED_CELLS] * eroded_cells[board];
+
+    return score;
+}
+
+static void board_features_scalar(const arena_row_t* rows, int width, int height, int64_t* features)
+{
+    const arena_row_t full = full_row_mask(width);
+    const arena_row_t inner = full_row_mask(width - 1);
+    const arena_row_t right_wall = (arena_row_t)1 << (width - 1);
+
+    arena_row_t covered = 0;
+    arena_row_t runs[ARENA_MAX_HEIGHT + 1];
+    int depth = 0;
+
+    for (int i = 0; i < EVAL_FEATURES; i++) features[i] = 0;
+
+    for (int y = 0; y < height; y++) {
+        arena_row_t row = rows[y];
+
+        features[EVAL_ROW_TRANSITIONS] += __builtin_popcountll((row ^ ((row >> 1) | right_wall)) & full) + (~row & 1);
+        if (y > 0) features[EVAL_COLUMN_TRANSITIONS] += __builtin_popcountll(row ^ rows[y - 1]);
+
+        covered |= row;
+        features[EVAL_HOLES] += __builtin_popcountll(covered & ~row);
+        features[EVAL_AGGREGATE_HEIGHT] += __builtin_popcountll(covered);
+        features[EVAL_BUMPINESS] += __builtin_popcountll((covered ^ (covered >> 1)) & inner);
+        features[EVAL_MAX_HEIGHT] += covered != 0;
+
+        arena_row_t well = ~row & ((row << 1) | 1) & ((row >> 1) | right_wall) & full;
+        for (int k = depth; k > 0; k--) runs[k] = runs[k - 1] & well;
+        runs[0] = well;
+        depth++;
+        while (depth > 0 && runs[depth - 1] == 0) depth--;
+        for (int k = 0; k < depth; k++) features[EVAL_WELLS] += __builtin_popcountll(runs[k]);
+    }
+    // the floor is filled
+    features[EVAL_COLUMN_TRANSITIONS] += __builtin_popcountll(~rows[height - 1] & full);
+}
+
+static void evaluate_boards_scalar(const struct Evaluator* evaluator, const arena_row_t* rows, int first, int count,
+                                   int width, int height, const float* landing_heights, const uint8_t* eroded_cells, float* scores)
+{
+    int64_t features[EVAL_FEATURES];
+
+    for (int board = first; board < count; board++) {
+        board_features_scalar(rows + (size_t)board * height, width, height, features);
+        scores[board] = weigh_features(evaluator, features, landing_heights, eroded_cells, board);
+    }
+}
+
+#ifdef EVAL_X86
+
+/*
+    Population count of every 64 bit lane with the SWAR method, SSE2 has no byte shuffle.
+*/
+static inline __m128i popcount_sse2(__m128i v)
+{
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0f);
+
+    v = _mm_sub_epi64(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+    v = _mm_add_epi64(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+    v = _mm_and_si128(_mm_add_epi64(v, _mm_srli_epi64(v, 4)), m4);
+    return _mm_sad_epu8(v, _mm_setzero_si128());
+}
+
+static inline bool any_sse2(__m128i v)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_setzero_si128())) != 0xffff;
+}
+
+/*
+    Same as board_features_scalar for 2 boards, board i in lane i.
+*/
+static void evaluate_boards_sse2(const struct Evaluator* evaluator, const arena_row_t* rows, int count,
+                                 int width, int height, const float* landing_heights, const uint8_t* eroded_cells, float* scores)
+{
+    const __m128i full = _mm_set1_epi64x(full_row_mask(width));
+    const __m128i inner = _mm_set1_epi64x(full_row_mask(width - 1));
+    const __m128i right_wall = _mm_set1_epi64x((arena_row_t)1 << (width - 1));
+    const __m128i one = _mm_set1_epi64x(1);
+    const __m128i zero = _mm_setzero_si128();
+
+    int board = 0;
+    for (; board + 2 <= count; board += 2) {
+        const arena_row_t* board_rows = rows + (size_t)board * height;
+
+        __m128i counts[EVAL_FEATURES];
+        for (int i = 0; i < EVAL_FEATURES; i++) counts[i] = zero;
+
+        __m128i covered = zero;
+        __m128i previous = zero;
+        __m128i runs[ARENA_MAX_HEIGHT + 1];
+        int depth = 0;
+
+        for (int y = 0; y < height; y++) {
+            __m128i row = _mm_set_epi64x(board_rows[height + y], board_rows[y]);
+
+            __m128i transitions = _mm_and_si128(_mm_xor_si128(row, _mm_or_si128(_mm_srli_epi64(row, 1), right_wall)), full);
+            counts[EVAL_ROW_TRANSITIONS] = _mm_add_epi64(counts[EVAL_ROW_TRANSITIONS],
+                _mm_add_epi64(popcount_sse2(transitions), _mm_andnot_si128(row, one)));
+            if (y > 0) counts[EVAL_COLUMN_TRANSITIONS] = _mm_add_epi64(counts[EVAL_COLUMN_TRANSITIONS], popcount_sse2(_mm_xor_si128(row, previous)));
+            previous = row;
+
+            covered = _mm_or_si128(covered, row);
+            counts[EVAL_HOLES] = _mm_add_epi64(counts[EVAL_HOLES], popcount_sse2(_mm_andnot_si128(row, covered)));
+            counts[EVAL_AGGREGATE_HEIGHT] = _mm_add_epi64(counts[EVAL_AGGREGATE_HEIGHT], popcount_sse2(covered));
+            counts[EVAL_BUMPINESS] = _mm_add_epi64(counts[EVAL_BUMPINESS],
+                popcount_sse2(_mm_and_si128(_mm_xor_si128(covered, _mm_srli_epi64(covered, 1)), inner)));
+            // (covered | -covered) has the top bit set exactly when covered isn't 0
+            counts[EVAL_MAX_HEIGHT] = _mm_add_epi64(counts[EVAL_MAX_HEIGHT],
+                _mm_srli_epi64(_mm_or_si128(covered, _mm_sub_epi64(zero, covered)), 63));
+
+            __m128i well = _mm_andnot_si128(row, _mm_and_si128(_mm_or_si128(_mm_slli_epi64(row, 1), one),
+                                                               _mm_or_si128(_mm_srli_epi64(row, 1), right_wall)));
+            well = _mm_and_si128(well, full);
+            for (int k = depth; k > 0; k--) runs[k] = _mm_and_si128(runs[k - 1], well);
+            runs[0] = well;
+            depth++;
+            while (depth > 0 && !any_sse2(runs[depth - 1])) depth--;
+            for (int k = 0; k < depth; k++) counts[EVAL_WELLS] = _mm_add_epi64(counts[EVAL_WELLS], popcount_sse2(runs[k]));
+        }
+        counts[EVAL_COLUMN_TRANSITIONS] = _mm_add_epi64(counts[EVAL_COLUMN_TRANSITIONS], popcount_sse2(_mm_andnot_si128(previous, full)));
+
+        int64_t lanes[EVAL_FEATURES][2];
+        for (int i = 0; i < EVAL_FEATURES; i++) _mm_storeu_si128((__m128i*)lanes[i], counts[i]);
+
+        for (int lane = 0; lane < 2; lane++) {
+            int64_t features[EVAL_FEATURES];
+            for (int i = 0; i < EVAL_FEATURES; i++) features[i] = lanes[i][lane];
+            scores[board + lane] = weigh_features(evaluator, features, landing_heights, eroded_cells, board + lane);
+        }
+    }
+
+    evaluate_boards_scalar(evaluator, rows, board, count, width, height, landing_heights, eroded_cells, scores);
+}
+
+/*
+    Population count of every 64 bit lane: a shuffle looks up the count of every nibble, the sums of the bytes add them up.
+*/
+__attribute__((target("avx2"))) static inline __m256i popcount_avx2(__m256i v)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibbles = _mm256_set1_epi8(0x0f);
+
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibbles));
+    __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi64(v, 4), nibbles));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+/*
+    Same as board_features_scalar for 4 boards, board i in lane i.
+*/
+__attribute__((target("avx2")))
+static void evaluate_boards_avx2(const struct Evaluator* evaluator, const arena_row_t* rows, int count,
+                                 int width, int height, const float* landing_heights, const uint8_t* eroded_cells, float* scores)
+{
+    const __m256i full = _mm256_set1_epi64x(full_row_mask(width));
+    const __m256i inner = _mm256_set1_epi64x(full_row_mask(width - 1));
+    const __m256i right_wall = _mm256_set1_epi64x((arena_row_t)1 << (width - 1));
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i zero = _mm256_setzero_si256();
+
+    int board = 0;
+    for (; board + 4 <= count; board += 4) {
+        const arena_row_t* board_rows = rows + (size_t)board * height;
+
+        __m256i counts[EVAL_FEATURES];
+        for (int i = 0; i < EVAL_FEATURES; i++) counts[i] = zero;
+
+        __m256i covered = zero;
+        __m256i previous = zero;
+        __m256i runs[ARENA_MAX_HEIGHT + 1];
+        int depth = 0;
+
+        for (int y = 0; y < height; y++) {
+            __m256i row = _mm256_set_epi64x(board_rows[3 * height + y], board_rows[2 * height + y],
+                                            board_rows[height + y], board_rows[y]);
+
+            __m256i transitions = _mm256_and_si256(_mm256_xor_si256(row, _mm256_or_si256(_mm256_srli_epi64(row, 1), right_wall)), full);
+            counts[EVAL_ROW_TRANSITIONS] = _mm256_add_epi64(counts[EVAL_ROW_TRANSITIONS],
+                _mm256_add_epi64(popcount_avx2(transitions), _mm256_andnot_si256(row, one)));
+            if (y > 0) counts[EVAL_COLUMN_TRANSITIONS] = _mm256_add_epi64(counts[EVAL_COLUMN_TRANSITIONS], popcount_avx2(_mm256_xor_si256(row, previous)));
+            previous = row;
+
+            covered = _mm256_or_si256(covered, row);
+            counts[EVAL_HOLES] = _mm256_add_epi64(counts[EVAL_HOLES], popcount_avx2(_mm256_andnot_si256(row, covered)));
+            counts[EVAL_AGGREGATE_HEIGHT] = _mm256_add_epi64(counts[EVAL_AGGREGATE_HEIGHT], popcount_avx2(covered));
+            counts[EVAL_BUMPINESS] = _mm256_add_epi64(counts[EVAL_BUMPINESS],
+                popcount_avx2(_mm256_and_si256(_mm256_xor_si256(covered, _mm256_srli_epi64(covered, 1)), inner)));
+            counts[EVAL_MAX_HEIGHT] = _mm256_add_epi64(counts[EVAL_MAX_HEIGHT],
+                _mm256_srli_epi64(_mm256_or_si256(covered, _mm256_sub_epi64(zero, covered)), 63));
+
+            __m256i well = _mm256_andnot_si256(row, _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi64(row, 1), one),
+                                                                     _mm256_or_si256(_mm256_srli_epi64(row, 1), right_wall)));
+            well = _mm256_and_si256(well, full);
+            for (int k = depth; k > 0; k--) runs[k] = _mm256_and_si256(runs[k - 1], well);
+            runs[0] = well;
+            depth++;
+            while (depth > 0 && _mm256_testz_si256(runs[depth - 1], runs[depth - 1])) depth--;
+            for (int k = 0; k < depth; k++) counts[EVAL_WELLS] = _mm256_add_epi64(counts[EVAL_WELLS], popcount_avx2(runs[k]));
+        }
+        counts[EVAL_COLUMN_TRANSITIONS] = _mm256_add_epi64(counts[EVAL_COLUMN_TRANSITIONS], popcount_avx2(_mm256_andnot_si256(previous, full)));
+
+        int64_t lanes[EVAL_FEATURES][4];
+        for (int i = 0; i < EVAL_FEATURES; i++) _mm256_storeu_si256((__m256i*)lanes[i], counts[i]);
+
+        for (int lane = 0; lane < 4; lane++) {
+            int64_t features[EVAL_FEATURES];
+            for (int i = 0; i < EVAL_FEATURES; i++) features[i] = lanes[i][lane];
+            scores[board + lane] = weigh_features(evaluator, features, landing_heights, eroded_cells, board + lane);
+        }
+    }
+
+    evaluate_boards_scalar(evaluator, rows, board, count, width, height, landing_heights, eroded_cells, scores);
+}
+
+#endif
+
+void evaluate_boards(const struct Evaluator* evaluator, const arena_row_t* rows, int count, int width, int height,
+                     const float* landing_heights, const uint8_t* eroded_cells, float* scores)
+{
+    switch (evaluator->kernel) {
+#ifdef EVAL_X86
+        case EVAL_KERNEL_SSE2:
+            evaluate_boards_sse2(evaluator, rows, count, width, height, landing_heights, eroded_cells, scores);
+            break;
+        case EVAL_KERNEL_AVX2:
+            evaluate_boards_avx2(evaluator, rows, count, width, height, landing_heights, eroded_cells, scores);
+            break;
+#endif
+        default:
+            evaluate_boards_scalar(evaluator, rows, 0, count, width, height, landing_heights, eroded_cells, scores);
+            break;
+    }
+}
+
+void rate_placements(const struct Evaluator* evaluator, const struct GameData* game_data, const struct PlacementList* list,
+                     int first, int count, struct PlacementRatings* ratings)
+{
+    int height = game_data->height;
+
+    for (int i = 0; i < count; i++) {
+        const struct Placement* placement = &list->placements[first + i];
+
+        ratings->landing_heights[i] = landing_height(game_data->current_piece, placement->rotation, placement->position_y, height);
+        ratings->eroded_cells[i] = eroded_piece_cells(game_data->arena_rows, game_data->width, game_data->current_piece,
+                                                      placement->rotation, placement->position_x, placement->position_y);
+        write_placement_rows(game_data, placement, ratings->rows + (size_t)i * height);
+    }
+    evaluate_boards(evaluator, ratings->rows, count, game_data->width, height,
+                    ratings->landing_heights, ratings->eroded_cells, ratings->scores);
+}
+
+void extract_board_features(const arena_row_t* rows, int width, int height, int features[EVAL_FEATURES])
+{
+    int64_t counts[EVAL_FEATURES];
+
+    board_features_scalar(rows, width, height, counts);
+    for (int i = 0; i < EVAL_FEATURES; i++) features[i] = (int)counts[i];
+}
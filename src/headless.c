@@ -0,0 +1,498 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tetris_engine.h"
+#include "verify.h"
+
+/*
+    Plays seeded games without a window and prints the result of every game.
+    The pieces are placed by a greedy bot that tries every rotation and column of the current piece
+    and keeps the placement with the best rating of the resulting board, by the beam search of beam_search.h
+    or by the rollouts of rollout.h.
+
+    In perft mode the placements of the move generator are counted instead: every placement of the current piece
+    is played, followed by every placement of the next piece and so on up to the given depth.
+    The number of leaves and the sum of their hashes change whenever the semantics of moves, rotations,
+    locks or line clears change, --verify compares them to the values of the standard positions below.
+*/
+
+#define MAX_PERFT_DEPTH 6
+
+enum Bot {
+    BOT_GREEDY,
+    BOT_BEAM,
+    BOT_ROLLOUT,
+};
+
+struct Options {
+    uint32_t seed;                  // seed of the first game, the following games use the next seeds
+    int games;
+    int max_pieces;                 // a game ends after this many pieces even if it isn't lost
+    struct GameConfig config;
+    int perft_depth;                // 0 plays games, otherwise the depth of the perft run
+    int warmup;                     // pieces placed by the bot before the perft starts, to get a position with blocks
+    bool random_warmup;             // the warmup pieces are placed at random placements instead of by the bot
+    bool verify;
+    enum Bot bot;
+    struct BeamConfig beam;
+    struct RolloutConfig rollout;
+};
+
+/*
+    A position of the perft regression and its expected result.
+    The blocks of the position are placed by the greedy bot of this file, so changing its rating changes the positions,
+    or at random placements drawn from the rng of the game.
+*/
+struct PerftPosition {
+    enum RuleSetType rule_set;
+    int width;
+    int height;
+    uint32_t seed;
+    int warmup;
+    bool random_warmup;
+    int depth;
+    uint64_t leaves;
+    uint64_t checksum;
+};
+
+static const struct PerftPosition PERFT_POSITIONS[] = {
+    { RULES_CLASSIC,   ARENA_WIDTH, ARENA_HEIGHT,  1,  0, false, 3, 42057, 0x3b1c37fb3226ee68 },
+    { RULES_CLASSIC,   ARENA_WIDTH, ARENA_HEIGHT,  2, 30, false, 3, 10177, 0x1e640a8541b0dcb1 },
+    { RULES_NES,       ARENA_WIDTH, ARENA_HEIGHT,  3, 50, false, 3,  5400, 0x7799968aec8d2915 },
+    { RULES_GUIDELINE, ARENA_WIDTH, ARENA_HEIGHT,  1,  0, false, 3, 11095, 0xc087d42f16860103 },
+    { RULES_GUIDELINE, ARENA_WIDTH, ARENA_HEIGHT,  4, 40, false, 3,  2868, 0xdab55566d8ab8b1f },
+    { RULES_GUIDELINE, 25,          12,           23, 20, true,  2,  9176, 0xe479b9bc7be78cc1 },   // kicks above the top row
+};
+
+static void print_usage(const char* program)
+{
+    printf("usage: %s [options]\n", program);
+    printf("    --seed N         seed of the first game (default 1)\n");
+    printf("    --games N        number of games played with consecutive seeds (default 1)\n");
+    printf("    --pieces N       maximum number of pieces per game (default 10000)\n");
+    printf("    --rules NAME     classic, nes or guideline (default classic)\n");
+    printf("    --width N        width of the arena (default %d)\n", ARENA_WIDTH);
+    printf("    --height N       height of the arena (default %d)\n", ARENA_HEIGHT);
+    printf("    --bot NAME       greedy, beam or rollout (default greedy)\n");
+    printf("    --beam-width N   positions kept by the beam search after every piece (default 64)\n");
+    printf("    --depth N        pieces the beam search looks ahead, 0 for the current and all preview pieces (default 0),\n");
+    printf("                     or pieces placed by a rollout after the candidate (default 4)\n");
+    printf("    --threads N      threads of the beam search or the rollouts, 0 for one per processor (default 0)\n");
+    printf("    --budget S       seconds the beam search may take per piece, 0 for no limit (default 0)\n");
+    printf("    --candidates N   placements of the current piece that are rolled out (default 8)\n");
+    printf("    --samples N      rollouts per piece, split across the candidates (default 256)\n");
+    printf("    --perft N        count the placements up to depth N (1 - %d) instead of playing\n", MAX_PERFT_DEPTH);
+    printf("    --warmup N       pieces placed by the bot before the perft starts (default 0)\n");
+    printf("    --random-warmup  place the warmup pieces at random placements instead\n");
+    printf("    --verify         run the perft of the standard positions and compare the results,\n");
+    printf("                     replay every generated placement of random games and compare the boards,\n");
+    printf("                     check that unplayable custom rules are rejected and run the self checks of verify.h\n");
+}
+
+static bool parse_options(int argc, char** argv, struct Options* options)
+{
+    options->seed = 1;
+    options->games = 1;
+    options->max_pieces = 10000;
+    options->config = default_game_config();
+    options->perft_depth = 0;
+    options->warmup = 0;
+    options->random_warmup = false;
+    options->verify = false;
+    options->bot = BOT_GREEDY;
+    options->beam = default_beam_config();
+    options->rollout = default_rollout_config();
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(argv[i], "--verify") == 0) {
+            options->verify = true;
+            continue;
+        }
+        if (strcmp(argv[i], "--random-warmup") == 0) {
+            options->random_warmup = true;
+            continue;
+        }
+        if (strcmp(argv[i], "--help") == 0 || value == NULL) return false;
+
+        if      (strcmp(argv[i], "--seed") == 0)   options->seed = strtoul(value, NULL, 10);
+        else if (strcmp(argv[i], "--games") == 0)  options->games = atoi(value);
+        else if (strcmp(argv[i], "--pieces") == 0) options->max_pieces = atoi(value);
+        else if (strcmp(argv[i], "--width") == 0)  options->config.width = atoi(value);
+        else if (strcmp(argv[i], "--height") == 0) options->config.height = atoi(value);
+        else if (strcmp(argv[i], "--perft") == 0)  options->perft_depth = atoi(value);
+        else if (strcmp(argv[i], "--warmup") == 0) options->warmup = atoi(value);
+        else if (strcmp(argv[i], "--beam-width") == 0) options->beam.beam_width = atoi(value);
+        else if (strcmp(argv[i], "--depth") == 0)      options->beam.depth = options->rollout.depth = atoi(value);
+        else if (strcmp(argv[i], "--threads") == 0)    options->beam.threads = options->rollout.threads = atoi(value);
+        else if (strcmp(argv[i], "--budget") == 0)     options->beam.time_budget = atof(value);
+        else if (strcmp(argv[i], "--candidates") == 0) options->rollout.candidates = atoi(value);
+        else if (strcmp(argv[i], "--samples") == 0)    options->rollout.samples = atoi(value);
+        else if (strcmp(argv[i], "--bot") == 0) {
+            if      (strcmp(value, "greedy") == 0) options->bot = BOT_GREEDY;
+            else if (strcmp(value, "beam") == 0)   options->bot = BOT_BEAM;
+            else if (strcmp(value, "rollout") == 0) options->bot = BOT_ROLLOUT;
+            else return false;
+        }
+        else if (strcmp(argv[i], "--rules") == 0) {
+            int width = options->config.width;
+            int height = options->config.height;
+
+            if      (strcmp(value, "classic") == 0)   options->config = rule_set_config(RULES_CLASSIC);
+            else if (strcmp(value, "nes") == 0)       options->config = rule_set_config(RULES_NES);
+            else if (strcmp(value, "guideline") == 0) options->config = rule_set_config(RULES_GUIDELINE);
+            else return false;
+
+            options->config.width = width;
+            options->config.height = height;
+        }
+        else return false;
+
+        i++;
+    }
+    return options->seed != 0 && options->games > 0 && options->max_pieces > 0
+        && options->perft_depth >= 0 && options->perft_depth <= MAX_PERFT_DEPTH && options->warmup >= 0
+        && options->beam.beam_width > 0 && options->beam.depth >= 0 && options->beam.threads >= 0
+        && options->rollout.candidates > 0 && options->rollout.samples > 0;
+}
+
+/*
+    Rating of a board after a placement, higher is better.
+    The weights are the ones found by Yiyuan Lee for his near perfect bot.
+*/
+static double rate_board(const struct GameData* game_data, size_t cleared_rows)
+{
+    const struct BoardFeatures* features = get_board_features(game_data);
+
+    return -0.510066 * features->aggregate_height
+           +0.760666 * cleared_rows
+           -0.35663  * features->holes
+           -0.184483 * features->bumpiness;
+}
+
+/*
+    Places the current piece with the given number of clockwise rotations in the given column and locks it.
+    Returns false when the piece can't get there.
+*/
+static bool place_piece(struct GameData* game_data, int rotations, int position_x, size_t* cleared_rows)
+{
+    for (int i = 0; i < rotations; i++) rotate_piece(game_data, RIGHT);
+    if (game_data->rotation != rotations) return false;
+
+    while (game_data->position_x > position_x) {
+        int previous = game_data->position_x;
+        move(game_data, LEFT);
+        if (game_data->position_x == previous) return false;
+    }
+    while (game_data->position_x < position_x) {
+        int previous = game_data->position_x;
+        move(game_data, RIGHT);
+        if (game_data->position_x == previous) return false;
+    }
+
+    *cleared_rows = hard_drop(game_data);
+    return true;
+}
+
+static void play_best_placement(struct GameData* game_data)
+{
+    struct GameData candidate;
+    double best_rating = 0.0;
+    int best_rotation = -1;
+    int best_x = 0;
+
+    for (int rotation = 0; rotation < PIECE_ROTATIONS; rotation++) {
+        for (int position_x = -3; position_x < game_data->width; position_x++) {
+            size_t cleared_rows;
+
+            gamedata_snapshot(game_data, &candidate);
+            if (!place_piece(&candidate, rotation, position_x, &cleared_rows)) continue;
+
+            double rating = rate_board(&candidate, cleared_rows) - (candidate.is_defeat ? 1e9 : 0.0);
+            if (best_rotation < 0 || rating > best_rating) {
+                best_rating = rating;
+                best_rotation = rotation;
+                best_x = position_x;
+            }
+        }
+    }
+
+    size_t cleared_rows;
+    if (best_rotation < 0 || !place_piece(game_data, best_rotation, best_x, &cleared_rows)) hard_drop(game_data);
+}
+
+/*
+    Places the current piece at a random placement drawn from the rng of the game. Random placements pile up
+    high, ragged boards on which paths climb over blocks and kicks lift pieces above the arena.
+*/
+static void play_random_placement(struct GameData* game_data, struct PlacementList* list)
+{
+    int count = generate_placements(game_data, list);
+
+    if (count > 0) play_placement(game_data, list, rng_range(&game_data->rng, count));
+    else hard_drop(game_data);
+}
+
+/*
+    Returns the seconds since an arbitrary point in time. Unlike clock it doesn't add up the time of several threads.
+*/
+static double get_seconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/*
+    Counts the placements of depth pieces and adds the hashes of the games after the last one to checksum.
+    Lost games are leaves as well. Returns the number of leaves, nodes counts every placement played.
+*/
+static uint64_t perft(const struct GameData* game_data, int depth, struct PlacementList* lists, uint64_t* checksum, uint64_t* nodes)
+{
+    struct PlacementList* list = &lists[0];
+    struct GameData child;
+    uint64_t leaves = 0;
+
+    int count = generate_placements(game_data, list);
+    for (int i = 0; i < count; i++) {
+        gamedata_snapshot(game_data, &child);
+        play_placement(&child, list, i);
+        (*nodes)++;
+
+        if (depth == 1 || child.is_defeat) {
+            *checksum += get_gamedata_hash(&child);
+            leaves++;
+        }
+        else leaves += perft(&child, depth - 1, lists + 1, checksum, nodes);
+    }
+    return leaves;
+}
+
+/*
+    Runs the perft of the game created from the seed and config after warmup pieces were placed by the bot,
+    or at random placements if random_warmup is set. Prints the result if print is set and returns the number of leaves.
+*/
+static uint64_t run_perft(uint32_t seed, const struct GameConfig* config, int warmup, bool random_warmup, int depth,
+                          uint64_t* checksum, bool print)
+{
+    // a list per depth, they are too large for the stack
+    static struct PlacementList lists[MAX_PERFT_DEPTH];
+    struct GameData game_data = init_gamedata_with_config(seed, config);
+
+    for (int i = 0; i < warmup && !game_data.is_defeat; i++) {
+        if (random_warmup) play_random_placement(&game_data, &lists[0]);
+        else play_best_placement(&game_data);
+    }
+
+    uint64_t nodes = 0;
+    *checksum = 0;
+    double start = get_seconds();
+    uint64_t leaves = perft(&game_data, depth, lists, checksum, &nodes);
+    double seconds = get_seconds() - start;
+
+    if (print) {
+        printf("perft seed %u rules %s %dx%d warmup %d%s depth %d: leaves %" PRIu64 " checksum %016" PRIx64
+               " nodes %" PRIu64 " in %.3f s (%.0f nodes/s)\n",
+               seed, game_data.rules.name, game_data.width, game_data.height, warmup, random_warmup ? " random" : "",
+               depth, leaves, *checksum, nodes, seconds,
+               (seconds > 0.0) ? nodes / seconds : 0.0);
+    }
+    return leaves;
+}
+
+/*
+    Runs the perft of the standard positions and returns the number of positions with wrong results.
+*/
+static int verify_perft(void)
+{
+    int failures = 0;
+    size_t positions = sizeof(PERFT_POSITIONS) / sizeof(PERFT_POSITIONS[0]);
+
+    for (size_t i = 0; i < positions; i++) {
+        const struct PerftPosition* position = &PERFT_POSITIONS[i];
+        struct GameConfig config = rule_set_config(position->rule_set);
+        uint64_t checksum;
+
+        config.width = position->width;
+        config.height = position->height;
+        uint64_t leaves = run_perft(position->seed, &config, position->warmup, position->random_warmup, position->depth,
+                                    &checksum, true);
+        if (leaves != position->leaves || checksum != position->checksum) {
+            printf("    expected leaves %" PRIu64 " checksum %016" PRIx64 "\n", position->leaves, position->checksum);
+            failures++;
+        }
+    }
+
+    printf("%s: %d of %zu positions wrong\n", (failures == 0) ? "passed" : "FAILED", failures, positions);
+    return failures;
+}
+
+/*
+    Replays every placement of the positions of games with random placements and compares the arena after
+    play_placement with the rows the placement describes. Returns the number of placements that differ.
+*/
+static int verify_placements(void)
+{
+    static struct PlacementList list;
+    static const struct { enum RuleSetType rule_set; int width; int height; } CONFIGS[] = {
+        { RULES_CLASSIC,   ARENA_WIDTH, ARENA_HEIGHT },
+        { RULES_NES,       ARENA_WIDTH, ARENA_HEIGHT },
+        { RULES_GUIDELINE, ARENA_WIDTH, ARENA_HEIGHT },
+        { RULES_GUIDELINE, 25, 12 },    // low arena, SRS kicks lift pieces above the top row
+    };
+    arena_row_t rows[ARENA_MAX_HEIGHT];
+    struct GameData child;
+    uint64_t placements = 0;
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(CONFIGS) / sizeof(CONFIGS[0]); i++) {
+        struct GameConfig config = rule_set_config(CONFIGS[i].rule_set);
+        config.width = CONFIGS[i].width;
+        config.height = CONFIGS[i].height;
+
+        for (uint32_t seed = 1; seed <= 100; seed++) {
+            struct GameData game_data = init_gamedata_with_config(seed, &config);
+
+            for (int piece = 0; piece < 40 && !game_data.is_defeat; piece++) {
+                int count = generate_placements(&game_data, &list);
+                for (int j = 0; j < count; j++) {
+                    write_placement_rows(&game_data, &list.placements[j], rows);
+                    gamedata_snapshot(&game_data, &child);
+                    play_placement(&child, &list, j);
+                    placements++;
+
+                    if (memcmp(rows, child.arena_rows, sizeof(arena_row_t) * game_data.height) != 0) {
+                        if (failures < 10) {
+                            printf("placement %d of piece %d seed %u rules %s %dx%d: rotation %d x %d y %d not reached\n",
+                                   j, piece, seed, game_data.rules.name, game_data.width, game_data.height,
+                                   list.placements[j].rotation, list.placements[j].position_x, list.placements[j].position_y);
+                        }
+                        failures++;
+                    }
+                }
+                play_random_placement(&game_data, &list);
+            }
+        }
+    }
+
+    printf("%s: %d of %" PRIu64 " placements wrong\n", (failures == 0) ? "passed" : "FAILED", failures, placements);
+    return failures;
+}
+
+/*
+    Checks that custom rules are only used when they can be played: rules without lines per level would divide
+    by zero on the first line clear, the game has to fall back to the classic rules and clear lines with them.
+    Returns the number of failed checks.
+*/
+static int verify_rule_sets(void)
+{
+    static const struct { const char* name; uint32_t lines_per_level; enum RuleSetType expected; } CASES[] = {
+        { "custom lines per level 5", 5, RULES_CUSTOM },
+        { "custom lines per level 0", 0, RULES_CLASSIC },
+    };
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+        struct RuleSet rules = CLASSIC_RULES;
+        rules.name = "custom";
+        rules.lines_per_level = CASES[i].lines_per_level;
+
+        struct GameConfig config = rule_set_config(RULES_CUSTOM);
+        config.rule_set = RULES_CUSTOM;
+        config.custom_rules = &rules;
+
+        struct GameData game_data = init_gamedata_with_config(1, &config);
+        for (int piece = 0; piece < 200 && !game_data.is_defeat; piece++) play_best_placement(&game_data);
+
+        bool passed = game_data.rule_set == CASES[i].expected && game_data.rules.lines_per_level > 0
+                      && game_data.cleared_lines > 0
+                      && game_data.level == rules_level(&game_data.rules, game_data.cleared_lines);
+        printf("rules %s: %s, %u lines level %u\n", CASES[i].name, game_data.rules.name,
+               game_data.cleared_lines, game_data.level);
+        if (!passed) failures++;
+    }
+
+    printf("%s: %d of %zu rule sets wrong\n", (failures == 0) ? "passed" : "FAILED", failures,
+           sizeof(CASES) / sizeof(CASES[0]));
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    struct Options options;
+    if (!parse_options(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (options.verify) {
+        int failures = verify_perft();
+        failures += verify_placements();
+        failures += verify_rule_sets();
+        failures += verify_undo();
+        failures += verify_ticks();
+        failures += verify_batch();
+        failures += verify_env();
+        failures += verify_observations();
+        failures += verify_evaluator();
+        return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (options.perft_depth > 0) {
+        uint64_t checksum;
+        for (int game = 0; game < options.games; game++) {
+            run_perft(options.seed + game, &options.config, options.warmup, options.random_warmup, options.perft_depth,
+                      &checksum, true);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    struct BeamSearch search;
+    if (options.bot == BOT_BEAM && !init_beam_search(&search, &options.beam)) {
+        fprintf(stderr, "can't allocate the beam search\n");
+        return EXIT_FAILURE;
+    }
+    struct RolloutSearch rollout;
+    if (options.bot == BOT_ROLLOUT && !init_rollout_search(&rollout, &options.rollout)) {
+        fprintf(stderr, "can't allocate the rollout search\n");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t total_pieces = 0;
+    uint64_t total_lines = 0;
+    double start = get_seconds();
+
+    for (int game = 0; game < options.games; game++) {
+        uint32_t seed = options.seed + game;
+        struct GameData game_data = init_gamedata_with_config(seed, &options.config);
+
+        int pieces = 0;
+        while (!game_data.is_defeat && pieces < options.max_pieces) {
+            if (options.bot == BOT_BEAM) {
+                if (!beam_search_play(&search, &game_data)) hard_drop(&game_data);
+            }
+            else if (options.bot == BOT_ROLLOUT) {
+                if (!rollout_search_play(&rollout, &game_data)) hard_drop(&game_data);
+            }
+            else play_best_placement(&game_data);
+            pieces++;
+        }
+
+        printf("seed %u: pieces %d lines %u score %u level %u hash %016" PRIx64 "%s\n",
+               seed, pieces, game_data.cleared_lines, game_data.score, game_data.level,
+               get_gamedata_hash(&game_data), game_data.is_defeat ? "" : " (not lost)");
+
+        total_pieces += pieces;
+        total_lines += game_data.cleared_lines;
+    }
+
+    double seconds = get_seconds() - start;
+    printf("%d games, %" PRIu64 " pieces, %" PRIu64 " lines in %.3f s (%.0f pieces/s)\n",
+           options.games, total_pieces, total_lines, seconds, (seconds > 0.0) ? total_pieces / seconds : 0.0);
+
+    if (options.bot == BOT_BEAM) destroy_beam_search(&search);
+    if (options.bot == BOT_ROLLOUT) destroy_rollout_search(&rollout);
+    return EXIT_SUCCESS;
+}
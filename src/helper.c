@@ -1,10 +1,12 @@
 #include "helper.h"
 
-void print_piece(const int* piece, int size) {
+void print_piece(enum Piece piece, int rotation) {
+    const struct PieceShape* shape = get_piece_shape(piece, rotation);
+    int size = PIECE_SIZES[piece];
 
     for(int y = 0; y < size; y++) {
         for (int x = 0; x < size; x++) {
-            printf("%d ", piece[x + y * size + 1]);
+            printf("%d ", (shape->row_masks[y] >> x) & 1 ? get_piece_block_id(piece) : 0);
         }
 
         printf("\n");
@@ -211,6 +211,9 @@ static void init_uniforms(user_data_t* user_data)
     user_data->block_positions = glGetUniformLocation(user_data->shader_program_blocks, "block_positions");
     gl_check_error("glGetUniformLocation [block_position]");
 
+    user_data->arena_width_uniform = glGetUniformLocation(user_data->shader_program_blocks, "arena_width");
+    gl_check_error("glGetUniformLocation [arena_width_uniform]");
+
     user_data->background_sampler_uniform = glGetUniformLocation(user_data->shader_program_back, "texture_");
     gl_check_error("glGetUniformLocation [background_sampler_uniform]");
 
@@ -365,12 +368,11 @@ static void load_model(const char* model_path, GLuint vao, GLuint vbo, int* vert
 static void init_model(user_data_t* user_data)
 {
     user_data->last_frame_time = glfwGetTime();
-    user_data->time_since_last_drop = 0.0;
+    user_data->tick_accumulator = 0.0;
     user_data->gameData = init_gamedata(0);
 
-    user_data->holding_left = false;
-    user_data->holding_right = false;
-    user_data->time_since_last_side_move = 0.0;
+    user_data->held_inputs = 0;
+    user_data->pressed_inputs = 0;
 }
 
 void load_audio_files(struct WavData** data)
@@ -564,6 +566,4 @@ void teardown_gl(GLFWwindow* window)
     // Delete the texture:
     glDeleteTextures(16, user_data->textures);
     gl_check_error("glDeleteTextures");
-
-    free_gamedata(&user_data->gameData);
 }
\ No newline at end of file
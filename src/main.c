@@ -27,7 +27,7 @@ void window_size_callback(GLFWwindow* window, int width, int height)
 }
 
 void play_sio_sound(const user_data_t* user_data) {
-    if (user_data->gameData.current_piece[0] == PIECE_O) queue_audio_if_empty(user_data->effect_device, user_data->wav_data[3]);
+    if (user_data->gameData.current_piece == PIECE_O) queue_audio_if_empty(user_data->effect_device, user_data->wav_data[3]);
 }
 
 // eventhandler for the keyboard
@@ -39,33 +39,33 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         if (key == GLFW_KEY_A) {
             if (user_data->gameData.gameState == GAME_OVER) return;
 
-            if (!user_data->holding_left) move(&user_data->gameData, LEFT);
-            user_data->holding_left  = true;
+            user_data->held_inputs    |= INPUT_LEFT;
+            user_data->pressed_inputs |= INPUT_LEFT;
 
             // fix when pressed simultaneously
-            user_data->holding_right = false;
+            user_data->held_inputs &= ~INPUT_RIGHT;
         }
         else if (key == GLFW_KEY_D) {
             if (user_data->gameData.gameState == GAME_OVER) return;
 
-            if (!user_data->holding_right) move(&user_data->gameData, RIGHT);
-            user_data->holding_right = true;
+            user_data->held_inputs    |= INPUT_RIGHT;
+            user_data->pressed_inputs |= INPUT_RIGHT;
 
             // fix when pressed simultaneously
-            user_data->holding_left  = false;
+            user_data->held_inputs &= ~INPUT_LEFT;
         }
         else if (key == GLFW_KEY_RIGHT) {
             if (user_data->gameData.gameState == GAME_OVER) return;
-            rotate_piece(&user_data->gameData, RIGHT);
+            user_data->pressed_inputs |= INPUT_ROTATE_RIGHT;
             play_sio_sound(user_data);
         }
         else if (key == GLFW_KEY_LEFT) {
             if (user_data->gameData.gameState == GAME_OVER) return;
 
-            rotate_piece(&user_data->gameData, LEFT);
+            user_data->pressed_inputs |= INPUT_ROTATE_LEFT;
             play_sio_sound(user_data);
         }
-        else if (key == GLFW_KEY_S)     user_data->gameData.fast_drop = true;
+        else if (key == GLFW_KEY_S)     user_data->held_inputs |= INPUT_SOFT_DROP;
         else if (key == GLFW_KEY_P)     {
             if (user_data->gameData.gameState == GAME_OVER) return;
 
@@ -74,14 +74,13 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         else if (key == GLFW_KEY_ESCAPE) glfwSetWindowShouldClose(window, 1);
         else if (key == GLFW_KEY_R) {
             if (user_data->gameData.gameState == GAME_OVER) {
-                free_gamedata(&user_data->gameData);
                 user_data->gameData = init_gamedata(0);
             }
         }
     } else if (action == GLFW_RELEASE) {
-        if (key == GLFW_KEY_S)      user_data->gameData.fast_drop = false;
-        else if (key == GLFW_KEY_A) user_data->holding_left  = false;
-        else if (key == GLFW_KEY_D) user_data->holding_right = false;
+        if (key == GLFW_KEY_S)      user_data->held_inputs &= ~INPUT_SOFT_DROP;
+        else if (key == GLFW_KEY_A) user_data->held_inputs &= ~INPUT_LEFT;
+        else if (key == GLFW_KEY_D) user_data->held_inputs &= ~INPUT_RIGHT;
     }
 }
 
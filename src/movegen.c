@@ -0,0 +1,249 @@
+#include "movegen.h"
+
+/*
+    The search stores positions as bits of 64 bit masks, one mask per rotation and column.
+    Bit i stands for position_y = height - 1 - i + FLOOR_BITS: bit 0 is below the floor, the bits grow upwards
+    like the column masks of the board features. The lowest FLOOR_BITS bits stand for the rows below
+    the floor, they are always blocked.
+*/
+#define FLOOR_BITS 4
+#define ROWS_ABOVE 8            // positions further above the arena are treated as blocked
+#define COLUMN_OFFSET 3         // position_x of -3 is column index 0
+
+#define POSITION_TO_BIT(position_y, height) ((height) - 1 - (position_y) + FLOOR_BITS)
+#define BIT_TO_POSITION(bit, height) ((height) - 1 - (bit) + FLOOR_BITS)
+
+/*
+    Scratch state of a search, the masks of every rotation are indexed by position_x + COLUMN_OFFSET.
+*/
+struct Search {
+    uint64_t blocked[PIECE_ROTATIONS][ARENA_MAX_WIDTH + COLUMN_OFFSET];     // bit set when the piece collides there
+    uint64_t visited[PIECE_ROTATIONS][ARENA_MAX_WIDTH + COLUMN_OFFSET];
+    uint64_t landed[PIECE_ROTATIONS][ARENA_MAX_WIDTH + COLUMN_OFFSET];      // placements found, by canonical rotation
+    int8_t canonical[PIECE_ROTATIONS][3];       // rotation, x and y offset of the first rotation covering the same cells
+    const struct KickList* kicks[PIECE_ROTATIONS][2];
+};
+
+/*
+    Helper function that finds for every rotation of the piece the first rotation with the same cells,
+    so that placements which only differ in their rotation can be detected.
+*/
+static void find_canonical_rotations(enum Piece piece, struct Search* search)
+{
+    for (int rotation = 0; rotation < PIECE_ROTATIONS; rotation++) {
+        const struct PieceShape* shape = get_piece_shape(piece, rotation);
+
+        for (int other = 0; other <= rotation; other++) {
+            const struct PieceShape* other_shape = get_piece_shape(piece, other);
+            int offset_x = shape->cells[0][0] - other_shape->cells[0][0];
+            int offset_y = shape->cells[0][1] - other_shape->cells[0][1];
+
+            // the cells are sorted, so equal shapes have the same offset between all of their cells
+            bool same = true;
+            for (int i = 1; i < PIECE_BLOCKS; i++) {
+                same &= shape->cells[i][0] - other_shape->cells[i][0] == offset_x
+                     && shape->cells[i][1] - other_shape->cells[i][1] == offset_y;
+            }
+            if (same) {
+                search->canonical[rotation][0] = other;
+                search->canonical[rotation][1] = offset_x;
+                search->canonical[rotation][2] = offset_y;
+                break;
+            }
+        }
+    }
+}
+
+/*
+    Helper function that builds the collision masks of every rotation and column from the column masks.
+    A block at row y + block_y collides when its column has bit i - block_y set, so the column mask is shifted by block_y.
+*/
+BOARD_INLINE void build_blocked_masks(const struct GameData* game_data, enum Piece piece, struct Search* search,
+                                      int width, int height)
+{
+    const uint32_t* column_masks = get_board_features(game_data)->column_masks;
+    const uint64_t floor = ((uint64_t)1 << FLOOR_BITS) - 1;
+    const uint64_t ceiling = ~(uint64_t)0 << (POSITION_TO_BIT(-ROWS_ABOVE, height) + 1);
+
+    for (int rotation = 0; rotation < PIECE_ROTATIONS; rotation++) {
+        const struct PieceShape* shape = get_piece_shape(piece, rotation);
+
+        for (int column = 0; column < width + COLUMN_OFFSET; column++) {
+            int position_x = column - COLUMN_OFFSET;
+            uint64_t blocked = ceiling;
+
+            if (!board_piece_inside_walls(shape, position_x, width)) blocked = ~(uint64_t)0;
+            else {
+                for (int i = 0; i < PIECE_BLOCKS; i++) {
+                    uint64_t column_mask = ((uint64_t)column_masks[position_x + shape->cells[i][0]] << FLOOR_BITS) | floor;
+                    blocked |= column_mask << shape->cells[i][1];
+                }
+            }
+            search->blocked[rotation][column] = blocked;
+            search->visited[rotation][column] = 0;
+            search->landed[rotation][column] = 0;
+        }
+    }
+}
+
+/*
+    Helper function that adds a position to the search if it is free and new.
+    When the piece rests on the ground there, the placement is recorded unless one with the same cells was found before.
+*/
+BOARD_INLINE void visit(struct Search* search, struct PlacementList* list, int rotation, int column, int bit,
+                        enum PlacementStep step, int parent, int width, int height)
+{
+    if (column < 0 || column >= width + COLUMN_OFFSET) return;
+
+    uint64_t mask = (uint64_t)1 << bit;
+    if ((search->blocked[rotation][column] & mask) || (search->visited[rotation][column] & mask)) return;
+    if (list->node_count == PLACEMENT_MAX_NODES) return;
+
+    search->visited[rotation][column] |= mask;
+
+    int index = list->node_count++;
+    struct PlacementNode* node = &list->nodes[index];
+    node->rotation = rotation;
+    node->position_x = column - COLUMN_OFFSET;
+    node->position_y = BIT_TO_POSITION(bit, height);
+    node->step = step;
+    node->parent = (parent < 0) ? index : parent;
+
+    if (search->blocked[rotation][column] & (mask >> 1)) {
+        const int8_t* canonical = search->canonical[rotation];
+        uint64_t landed_mask = (uint64_t)1 << (bit - canonical[2]);
+        uint64_t* landed = &search->landed[canonical[0]][column + canonical[1]];
+
+        if (!(*landed & landed_mask)) {
+            *landed |= landed_mask;
+            list->placements[list->count++] = (struct Placement){
+                .rotation = node->rotation,
+                .position_x = node->position_x,
+                .position_y = node->position_y,
+                .node = index,
+            };
+        }
+    }
+}
+
+BOARD_INLINE int generate_placements_sized(const struct GameData* game_data, struct PlacementList* list, struct Search* search,
+                                           int width, int height)
+{
+    enum Piece piece = game_data->current_piece;
+
+    list->count = 0;
+    list->node_count = 0;
+
+    if (game_data->position_y < -ROWS_ABOVE) return 0;
+
+    find_canonical_rotations(piece, search);
+    build_blocked_masks(game_data, piece, search, width, height);
+    for (int rotation = 0; rotation < PIECE_ROTATIONS; rotation++) {
+        search->kicks[rotation][0] = get_rotation_kicks(game_data->rotation_system, piece, rotation, false);
+        search->kicks[rotation][1] = get_rotation_kicks(game_data->rotation_system, piece, rotation, true);
+    }
+
+    visit(search, list, game_data->rotation, game_data->position_x + COLUMN_OFFSET,
+          POSITION_TO_BIT(game_data->position_y, height), STEP_DROP, -1, width, height);
+
+    // the nodes are the queue of the breadth first search
+    for (int index = 0; index < list->node_count; index++) {
+        const struct PlacementNode node = list->nodes[index];
+        int column = node.position_x + COLUMN_OFFSET;
+        int bit = POSITION_TO_BIT(node.position_y, height);
+
+        visit(search, list, node.rotation, column - 1, bit, STEP_LEFT, index, width, height);
+        visit(search, list, node.rotation, column + 1, bit, STEP_RIGHT, index, width, height);
+
+        for (int clockwise = 1; clockwise >= 0; clockwise--) {
+            int rotation = (node.rotation + (clockwise ? 1 : PIECE_ROTATIONS - 1)) % PIECE_ROTATIONS;
+            const struct KickList* kicks = search->kicks[node.rotation][clockwise];
+
+            // the first kick that fits is taken, like rotate_piece does
+            for (int i = 0; i < kicks->count; i++) {
+                int kicked_column = column + kicks->offsets[i][0];
+                int kicked_bit = bit - kicks->offsets[i][1];
+
+                if (kicked_column < 0 || kicked_column >= width + COLUMN_OFFSET || kicked_bit < 0) continue;
+                if (search->blocked[rotation][kicked_column] & ((uint64_t)1 << kicked_bit)) continue;
+
+                visit(search, list, rotation, kicked_column, kicked_bit, clockwise ? STEP_ROTATE_RIGHT : STEP_ROTATE_LEFT, index, width, height);
+                break;
+            }
+        }
+
+        // the piece falls until the highest blocked position below it
+        uint64_t below = search->blocked[node.rotation][column] & (((uint64_t)1 << bit) - 1);
+        int ground = 63 - __builtin_clzll(below) + 1;
+        if (ground != bit) visit(search, list, node.rotation, column, ground, STEP_DROP, index, width, height);
+    }
+
+    return list->count;
+}
+
+int generate_placements(const struct GameData* game_data, struct PlacementList* list)
+{
+    struct Search search;
+    return WITH_ARENA_SIZE(game_data, generate_placements_sized, game_data, list, &search);
+}
+
+int get_placement_path(const struct PlacementList* list, int index, uint8_t* steps, int max_steps)
+{
+    int length = 0;
+    for (int node = list->placements[index].node; list->nodes[node].parent != node; node = list->nodes[node].parent) length++;
+
+    // the tree leads from the placement back to the start, so the steps are written from the end
+    int position = length;
+    for (int node = list->placements[index].node; list->nodes[node].parent != node; node = list->nodes[node].parent) {
+        position--;
+        if (position < max_steps) steps[position] = list->nodes[node].step;
+    }
+
+    return length;
+}
+
+void write_placement_rows(const struct GameData* game_data, const struct Placement* placement, arena_row_t* rows)
+{
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, placement->rotation);
+    arena_row_t full_row = full_row_mask(game_data->width);
+    int height = game_data->height;
+    bool filled = false;
+
+    memcpy(rows, game_data->arena_rows, sizeof(arena_row_t) * height);
+    for (int y = shape->min_y; y <= shape->max_y; y++) {
+        int row = placement->position_y + y;
+        if (row < 0) continue;
+
+        rows[row] |= shift_piece_row(shape->row_masks[y], placement->position_x);
+        filled |= rows[row] == full_row;
+    }
+    if (!filled) return;
+
+    int write = height - 1;
+    for (int row = height - 1; row >= 0; row--) {
+        if (rows[row] != full_row) rows[write--] = rows[row];
+    }
+    while (write >= 0) rows[write--] = 0;
+}
+
+void play_placement_step(struct GameData* game_data, enum PlacementStep step)
+{
+    switch (step) {
+        case STEP_LEFT:         move(game_data, LEFT); break;
+        case STEP_RIGHT:        move(game_data, RIGHT); break;
+        case STEP_ROTATE_RIGHT: rotate_piece(game_data, RIGHT); break;
+        case STEP_ROTATE_LEFT:  rotate_piece(game_data, LEFT); break;
+        // a kick can lift the piece above the arena, so the ground may be more than height rows below
+        case STEP_DROP:         fall(game_data, get_ghost_row(game_data) - game_data->position_y); break;
+    }
+}
+
+size_t play_placement(struct GameData* game_data, const struct PlacementList* list, int index)
+{
+    uint8_t steps[PLACEMENT_MAX_NODES];
+    int length = get_placement_path(list, index, steps, PLACEMENT_MAX_NODES);
+
+    for (int i = 0; i < length; i++) play_placement_step(game_data, steps[i]);
+
+    return hard_drop(game_data);
+}
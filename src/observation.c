@@ -0,0 +1,144 @@
+#include "observation.h"
+
+/*
+    Helper function that packs the rows of an arena into consecutive bits.
+    Whole bytes are flushed from a 64 bit accumulator, so a row costs a shift and an or.
+*/
+BOARD_INLINE size_t encode_rows_bits_sized(const arena_row_t* rows, uint8_t* buffer, int width, int height)
+{
+    uint64_t bits = 0;
+    int bit_count = 0;
+    size_t size = 0;
+
+    for (int y = 0; y < height; y++) {
+        // rows wider than 32 cells are added in two parts, so they always fit next to the remaining bits
+        for (int shift = 0; shift < width; shift += 32) {
+            int count = (width - shift < 32) ? width - shift : 32;
+            bits |= ((rows[y] >> shift) & ((UINT64_C(1) << count) - 1)) << bit_count;
+            bit_count += count;
+
+            while (bit_count >= 8) {
+                buffer[size++] = (uint8_t)bits;
+                bits >>= 8;
+                bit_count -= 8;
+            }
+        }
+    }
+    if (bit_count > 0) buffer[size++] = (uint8_t)bits;
+
+    return size;
+}
+
+BOARD_INLINE void encode_rows_plane_sized(const arena_row_t* rows, float* plane, int width, int height)
+{
+    for (int y = 0; y < height; y++) {
+        arena_row_t row = rows[y];
+        for (int x = 0; x < width; x++) plane[y * width + x] = (float)((row >> x) & 1);
+    }
+}
+
+/*
+    Helper function that computes the column heights from the rows, for games without board features.
+    Walking down from the top, the columns that appear for the first time in a row get their height.
+*/
+BOARD_INLINE void encode_rows_heights_sized(const arena_row_t* rows, float* heights, int width, int height)
+{
+    arena_row_t seen = 0;
+
+    for (int x = 0; x < width; x++) heights[x] = 0.0f;
+
+    for (int y = 0; y < height && seen != full_row_mask(width); y++) {
+        arena_row_t first = rows[y] & ~seen;
+        seen |= first;
+
+        while (first != 0) {
+            heights[__builtin_ctzll(first)] = (float)(height - y);
+            first &= first - 1;
+        }
+    }
+}
+
+/*
+    Helper function for the observation of games that are stored as rows, piece and preview.
+*/
+BOARD_INLINE void encode_rows_observation_sized(const arena_row_t* rows, enum Piece piece, const struct PieceQueue* preview,
+                                                float* observation, int width, int height)
+{
+    float* plane = observation;
+    float* pieces = plane + width * height;
+    float* heights = pieces + PIECE_TYPES * (1 + preview->depth);
+
+    encode_rows_plane_sized(rows, plane, width, height);
+    encode_piece_one_hot(piece, pieces);
+    for (int i = 0; i < preview->depth; i++) encode_piece_one_hot(piece_queue_peek(preview, i), pieces + PIECE_TYPES * (i + 1));
+    encode_rows_heights_sized(rows, heights, width, height);
+}
+
+size_t encode_board_bits(const struct GameData* game_data, uint8_t* buffer)
+{
+    return WITH_ARENA_SIZE(game_data, encode_rows_bits_sized, game_data->arena_rows, buffer);
+}
+
+void encode_board_plane(const struct GameData* game_data, float* plane)
+{
+    WITH_ARENA_SIZE(game_data, encode_rows_plane_sized, game_data->arena_rows, plane);
+}
+
+void encode_piece_one_hot(enum Piece piece, float* one_hot)
+{
+    for (int i = 0; i < PIECE_TYPES; i++) one_hot[i] = (i == (int)piece) ? 1.0f : 0.0f;
+}
+
+void encode_preview_one_hot(const struct GameData* game_data, float* one_hot)
+{
+    for (int i = 0; i < game_data->preview.depth; i++) {
+        encode_piece_one_hot(get_next_piece(game_data, i), one_hot + PIECE_TYPES * i);
+    }
+}
+
+void encode_column_heights(const struct GameData* game_data, float* heights)
+{
+    // the engine keeps the heights up to date, nothing has to be scanned
+    const struct BoardFeatures* features = get_board_features(game_data);
+    for (int x = 0; x < game_data->width; x++) heights[x] = features->column_heights[x];
+}
+
+void encode_observation(const struct GameData* game_data, float* observation)
+{
+    int cells = game_data->width * game_data->height;
+
+    encode_board_plane(game_data, observation);
+    encode_piece_one_hot(game_data->current_piece, observation + cells);
+    encode_preview_one_hot(game_data, observation + cells + PIECE_TYPES);
+    encode_column_heights(game_data, observation + cells + PIECE_TYPES * (1 + game_data->preview.depth));
+}
+
+BOARD_INLINE void encode_batch_board_bits_sized(const struct BatchGames* batch, uint8_t* buffer, int width, int height)
+{
+    size_t size = board_bits_size(width, height);
+
+    for (int game = 0; game < batch->count; game++) {
+        encode_rows_bits_sized(batch->rows + (size_t)game * height, buffer + game * size, width, height);
+    }
+}
+
+void encode_batch_board_bits(const struct BatchGames* batch, uint8_t* buffer)
+{
+    WITH_ARENA_SIZE(batch, encode_batch_board_bits_sized, batch, buffer);
+}
+
+BOARD_INLINE void encode_batch_observations_sized(const struct BatchGames* batch, float* observations, int width, int height)
+{
+    for (int game = 0; game < batch->count; game++) {
+        const struct PieceQueue* preview = &batch->preview[game];
+        size_t size = observation_size(width, height, preview->depth);
+
+        encode_rows_observation_sized(batch->rows + (size_t)game * height, batch->piece[game], preview,
+                                      observations + game * size, width, height);
+    }
+}
+
+void encode_batch_observations(const struct BatchGames* batch, float* observations)
+{
+    WITH_ARENA_SIZE(batch, encode_batch_observations_sized, batch, observations);
+}
@@ -0,0 +1,67 @@
+#include "pieces.h"
+
+/*
+    Generated by rotating the matrices listed in pieces.h clockwise, which is the same
+    transposition followed by reversing the rows the engine used to do at runtime.
+*/
+const struct PieceShape PIECE_SHAPES[PIECE_TYPES][PIECE_ROTATIONS] = {
+    // O-Block
+    {
+        { .cells = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } }, .row_masks = { 0x3, 0x3, 0x0, 0x0 }, .min_x = 0, .max_x = 1, .min_y = 0, .max_y = 1, .column_bottoms = { 1, 1, -1, -1 } },
+        { .cells = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } }, .row_masks = { 0x3, 0x3, 0x0, 0x0 }, .min_x = 0, .max_x = 1, .min_y = 0, .max_y = 1, .column_bottoms = { 1, 1, -1, -1 } },
+        { .cells = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } }, .row_masks = { 0x3, 0x3, 0x0, 0x0 }, .min_x = 0, .max_x = 1, .min_y = 0, .max_y = 1, .column_bottoms = { 1, 1, -1, -1 } },
+        { .cells = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } }, .row_masks = { 0x3, 0x3, 0x0, 0x0 }, .min_x = 0, .max_x = 1, .min_y = 0, .max_y = 1, .column_bottoms = { 1, 1, -1, -1 } },
+    },
+    // L-Block
+    {
+        { .cells = { { 1, 0 }, { 1, 1 }, { 1, 2 }, { 2, 2 } }, .row_masks = { 0x2, 0x2, 0x6, 0x0 }, .min_x = 1, .max_x = 2, .min_y = 0, .max_y = 2, .column_bottoms = { -1, 2, 2, -1 } },
+        { .cells = { { 0, 1 }, { 1, 1 }, { 2, 1 }, { 0, 2 } }, .row_masks = { 0x0, 0x7, 0x1, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 1, .max_y = 2, .column_bottoms = { 2, 1, 1, -1 } },
+        { .cells = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 1, 2 } }, .row_masks = { 0x3, 0x2, 0x2, 0x0 }, .min_x = 0, .max_x = 1, .min_y = 0, .max_y = 2, .column_bottoms = { 0, 2, -1, -1 } },
+        { .cells = { { 2, 0 }, { 0, 1 }, { 1, 1 }, { 2, 1 } }, .row_masks = { 0x4, 0x7, 0x0, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 0, .max_y = 1, .column_bottoms = { 1, 1, 1, -1 } },
+    },
+    // J-Block
+    {
+        { .cells = { { 1, 0 }, { 1, 1 }, { 0, 2 }, { 1, 2 } }, .row_masks = { 0x2, 0x2, 0x3, 0x0 }, .min_x = 0, .max_x = 1, .min_y = 0, .max_y = 2, .column_bottoms = { 2, 2, -1, -1 } },
+        { .cells = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 2, 1 } }, .row_masks = { 0x1, 0x7, 0x0, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 0, .max_y = 1, .column_bottoms = { 1, 1, 1, -1 } },
+        { .cells = { { 1, 0 }, { 2, 0 }, { 1, 1 }, { 1, 2 } }, .row_masks = { 0x6, 0x2, 0x2, 0x0 }, .min_x = 1, .max_x = 2, .min_y = 0, .max_y = 2, .column_bottoms = { -1, 2, 0, -1 } },
+        { .cells = { { 0, 1 }, { 1, 1 }, { 2, 1 }, { 2, 2 } }, .row_masks = { 0x0, 0x7, 0x4, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 1, .max_y = 2, .column_bottoms = { 1, 1, 2, -1 } },
+    },
+    // T-Block
+    {
+        { .cells = { { 0, 1 }, { 1, 1 }, { 2, 1 }, { 1, 2 } }, .row_masks = { 0x0, 0x7, 0x2, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 1, .max_y = 2, .column_bottoms = { 1, 2, 1, -1 } },
+        { .cells = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, 2 } }, .row_masks = { 0x2, 0x3, 0x2, 0x0 }, .min_x = 0, .max_x = 1, .min_y = 0, .max_y = 2, .column_bottoms = { 1, 2, -1, -1 } },
+        { .cells = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 2, 1 } }, .row_masks = { 0x2, 0x7, 0x0, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 0, .max_y = 1, .column_bottoms = { 1, 1, 1, -1 } },
+        { .cells = { { 1, 0 }, { 1, 1 }, { 2, 1 }, { 1, 2 } }, .row_masks = { 0x2, 0x6, 0x2, 0x0 }, .min_x = 1, .max_x = 2, .min_y = 0, .max_y = 2, .column_bottoms = { -1, 2, 1, -1 } },
+    },
+    // I-Block
+    {
+        { .cells = { { 2, 0 }, { 2, 1 }, { 2, 2 }, { 2, 3 } }, .row_masks = { 0x4, 0x4, 0x4, 0x4 }, .min_x = 2, .max_x = 2, .min_y = 0, .max_y = 3, .column_bottoms = { -1, -1, 3, -1 } },
+        { .cells = { { 0, 2 }, { 1, 2 }, { 2, 2 }, { 3, 2 } }, .row_masks = { 0x0, 0x0, 0xF, 0x0 }, .min_x = 0, .max_x = 3, .min_y = 2, .max_y = 2, .column_bottoms = { 2, 2, 2, 2 } },
+        { .cells = { { 1, 0 }, { 1, 1 }, { 1, 2 }, { 1, 3 } }, .row_masks = { 0x2, 0x2, 0x2, 0x2 }, .min_x = 1, .max_x = 1, .min_y = 0, .max_y = 3, .column_bottoms = { -1, 3, -1, -1 } },
+        { .cells = { { 0, 1 }, { 1, 1 }, { 2, 1 }, { 3, 1 } }, .row_masks = { 0x0, 0xF, 0x0, 0x0 }, .min_x = 0, .max_x = 3, .min_y = 1, .max_y = 1, .column_bottoms = { 1, 1, 1, 1 } },
+    },
+    // Z-Block
+    {
+        { .cells = { { 0, 1 }, { 1, 1 }, { 1, 2 }, { 2, 2 } }, .row_masks = { 0x0, 0x3, 0x6, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 1, .max_y = 2, .column_bottoms = { 1, 2, 2, -1 } },
+        { .cells = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 0, 2 } }, .row_masks = { 0x2, 0x3, 0x1, 0x0 }, .min_x = 0, .max_x = 1, .min_y = 0, .max_y = 2, .column_bottoms = { 2, 1, -1, -1 } },
+        { .cells = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 2, 1 } }, .row_masks = { 0x3, 0x6, 0x0, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 0, .max_y = 1, .column_bottoms = { 0, 1, 1, -1 } },
+        { .cells = { { 2, 0 }, { 1, 1 }, { 2, 1 }, { 1, 2 } }, .row_masks = { 0x4, 0x6, 0x2, 0x0 }, .min_x = 1, .max_x = 2, .min_y = 0, .max_y = 2, .column_bottoms = { -1, 2, 1, -1 } },
+    },
+    // S-Block
+    {
+        { .cells = { { 1, 1 }, { 2, 1 }, { 0, 2 }, { 1, 2 } }, .row_masks = { 0x0, 0x6, 0x3, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 1, .max_y = 2, .column_bottoms = { 2, 2, 1, -1 } },
+        { .cells = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 2 } }, .row_masks = { 0x1, 0x3, 0x2, 0x0 }, .min_x = 0, .max_x = 1, .min_y = 0, .max_y = 2, .column_bottoms = { 1, 2, -1, -1 } },
+        { .cells = { { 1, 0 }, { 2, 0 }, { 0, 1 }, { 1, 1 } }, .row_masks = { 0x6, 0x3, 0x0, 0x0 }, .min_x = 0, .max_x = 2, .min_y = 0, .max_y = 1, .column_bottoms = { 1, 1, 0, -1 } },
+        { .cells = { { 1, 0 }, { 1, 1 }, { 2, 1 }, { 2, 2 } }, .row_masks = { 0x2, 0x6, 0x4, 0x0 }, .min_x = 1, .max_x = 2, .min_y = 0, .max_y = 2, .column_bottoms = { -1, 1, 2, -1 } },
+    },
+};
+
+const int PIECE_SIZES[PIECE_TYPES] = {
+    [PIECE_O] = 2,
+    [PIECE_L] = 3,
+    [PIECE_J] = 3,
+    [PIECE_T] = 3,
+    [PIECE_I] = 4,
+    [PIECE_Z] = 3,
+    [PIECE_S] = 3,
+};
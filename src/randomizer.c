@@ -0,0 +1,82 @@
+#include "randomizer.h"
+
+static enum Piece next_uniform(struct Randomizer* randomizer, struct Rng* rng)
+{
+    (void)randomizer;
+    return (enum Piece)rng_range(rng, PIECE_TYPES);
+}
+
+/*
+    Deals a random piece out of the bag by swapping it with the last piece that is still in the bag.
+    When the bag is empty it is refilled with all 7 pieces.
+*/
+static enum Piece next_bag(struct Randomizer* randomizer, struct Rng* rng)
+{
+    if (randomizer->bag_left == 0) {
+        for (int i = 0; i < PIECE_TYPES; i++) randomizer->bag[i] = (enum Piece)i;
+        randomizer->bag_left = PIECE_TYPES;
+    }
+
+    int index = rng_range(rng, randomizer->bag_left);
+    enum Piece piece = randomizer->bag[index];
+
+    randomizer->bag_left--;
+    randomizer->bag[index] = randomizer->bag[randomizer->bag_left];
+    randomizer->bag[randomizer->bag_left] = piece;
+
+    return piece;
+}
+
+/*
+    The NES rolls one of 8 values. When it rolls the 8th value or the same piece as last time,
+    it rolls a second time between the 7 pieces and takes that result.
+*/
+static enum Piece next_nes(struct Randomizer* randomizer, struct Rng* rng)
+{
+    uint32_t roll = rng_range(rng, PIECE_TYPES + 1);
+
+    if (roll == PIECE_TYPES || (enum Piece)roll == randomizer->last) roll = rng_range(rng, PIECE_TYPES);
+
+    randomizer->last = (enum Piece)roll;
+    return randomizer->last;
+}
+
+static enum Piece (* const RANDOMIZER_FUNCTIONS[RANDOMIZER_TYPES])(struct Randomizer*, struct Rng*) = {
+    [RANDOMIZER_UNIFORM] = next_uniform,
+    [RANDOMIZER_BAG]     = next_bag,
+    [RANDOMIZER_NES]     = next_nes,
+};
+
+void init_randomizer(struct Randomizer* randomizer, enum RandomizerType type)
+{
+    randomizer->type = (type < RANDOMIZER_TYPES) ? type : RANDOMIZER_UNIFORM;
+    randomizer->bag_left = 0;
+
+    // no piece was drawn before, so the first NES roll is never rerolled because of a repeat
+    randomizer->last = (enum Piece)PIECE_TYPES;
+}
+
+enum Piece randomizer_next(struct Randomizer* randomizer, struct Rng* rng)
+{
+    return RANDOMIZER_FUNCTIONS[randomizer->type](randomizer, rng);
+}
+
+void init_piece_queue(struct PieceQueue* queue, int depth, struct Randomizer* randomizer, struct Rng* rng)
+{
+    if (depth < 1) depth = 1;
+    if (depth > PREVIEW_MAX_DEPTH) depth = PREVIEW_MAX_DEPTH;
+
+    queue->head = 0;
+    queue->depth = depth;
+    for (int i = 0; i < depth; i++) queue->pieces[i] = randomizer_next(randomizer, rng);
+}
+
+enum Piece piece_queue_pop(struct PieceQueue* queue, struct Randomizer* randomizer, struct Rng* rng)
+{
+    enum Piece piece = queue->pieces[queue->head];
+
+    queue->pieces[(queue->head + queue->depth) & (PREVIEW_MAX_DEPTH - 1)] = randomizer_next(randomizer, rng);
+    queue->head = (queue->head + 1) & (PREVIEW_MAX_DEPTH - 1);
+
+    return piece;
+}
@@ -80,7 +80,7 @@ void draw_next_piece(const user_data_t* user_data)
     glUseProgram(user_data->shader_program_single_block);
     glUniform1f(user_data->block_scale_uniform, 1.0f);
 
-    int block_id = user_data->gameData.next_piece[0] + 1;
+    int block_id = get_piece_block_id(get_next_piece(&user_data->gameData, 0));
     int model_index = block_id + 2;
 
     glUniform1i(user_data->block_id_uniform, block_id);
@@ -161,14 +161,19 @@ void draw_gl(GLFWwindow* window)
         glBindVertexArray(user_data->vao[0]);
         glBindBuffer(GL_ARRAY_BUFFER, user_data->vbo[0]);
 
-        int block_positions[200] = { 0 };
+        // the shader holds the cells of the standard arena, larger arenas only run headless
+        GLsizei block_count = (GLsizei)(user_data->gameData.width * user_data->gameData.height);
+        check_error(block_count <= RENDER_MAX_BLOCKS, "The arena is too large for the renderer.");
+
+        int block_positions[RENDER_MAX_BLOCKS] = { 0 };
         generate_block_positions(&user_data->gameData, block_positions);
 
         glUseProgram(user_data->shader_program_blocks);
-        glUniform1iv(user_data->block_positions, 200, block_positions);
+        glUniform1iv(user_data->block_positions, block_count, block_positions);
+        glUniform1i(user_data->arena_width_uniform, user_data->gameData.width);
 
         // Parameters: primitive type, start index, count
-        glDrawArraysInstanced(GL_TRIANGLES, 0, user_data->vertex_data_count[0], 200);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, user_data->vertex_data_count[0], block_count);
         gl_check_error("glDrawArraysInstanced");
 
         draw_text(user_data);
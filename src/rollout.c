@@ -0,0 +1,201 @@
+#include "rollout.h"
+
+struct RolloutConfig default_rollout_config(void)
+{
+    struct RolloutConfig config = {
+        .candidates = 8,
+        .samples = 256,
+        .depth = 4,
+        .threads = 0,
+        .seed = 0,
+    };
+    for (int i = 0; i < EVAL_FEATURES; i++) config.weights[i] = EL_TETRIS_WEIGHTS[i];
+
+    return config;
+}
+
+bool init_rollout_search(struct RolloutSearch* search, const struct RolloutConfig* config)
+{
+    search->config = *config;
+    if (search->config.candidates < 1) search->config.candidates = 1;
+    if (search->config.candidates > ROLLOUT_MAX_CANDIDATES) search->config.candidates = ROLLOUT_MAX_CANDIDATES;
+    if (search->config.samples < search->config.candidates) search->config.samples = search->config.candidates;
+    if (search->config.depth < 0) search->config.depth = 0;
+    if (search->config.threads < 1) search->config.threads = get_processor_count();
+
+    // a pool that can't start every thread runs on the ones it got, the search is sized for those and not for the config
+    init_thread_pool(&search->pool, search->config.threads);
+    search->config.threads = search->pool.thread_count;
+
+    init_evaluator(&search->evaluator, search->config.weights);
+
+    search->root_list = allocate_aligned(1, sizeof(struct PlacementList));
+    search->values = malloc(sizeof(float) * search->config.samples);
+    search->threads = allocate_aligned(search->config.threads, sizeof(struct RolloutThread));
+    search->game_data = NULL;
+    search->candidate_count = 0;
+    search->rollouts = 0;
+    search->nodes = 0;
+
+    if (!search->root_list || !search->values || !search->threads) {
+        destroy_rollout_search(search);
+        return false;
+    }
+    return true;
+}
+
+void destroy_rollout_search(struct RolloutSearch* search)
+{
+    destroy_thread_pool(&search->pool);
+
+    free(search->root_list);
+    free(search->values);
+    free(search->threads);
+}
+
+/*
+    Helper function that generates the placements of the game into ratings->list and returns the index
+    of the best rated one, the first one on equal ratings, or -1 when there is none.
+*/
+static int best_placement(const struct RolloutSearch* search, struct PlacementRatings* ratings, const struct GameData* game_data,
+                          float* rating)
+{
+    int count = generate_placements(game_data, &ratings->list);
+    int best = -1;
+
+    *rating = 0.0f;
+    for (int first = 0; first < count; first += EVAL_CHUNK) {
+        int chunk = (count - first < EVAL_CHUNK) ? count - first : EVAL_CHUNK;
+
+        rate_placements(&search->evaluator, game_data, &ratings->list, first, chunk, ratings);
+        for (int i = 0; i < chunk; i++) {
+            if (best < 0 || ratings->scores[i] > *rating) {
+                best = first + i;
+                *rating = ratings->scores[i];
+            }
+        }
+    }
+    return best;
+}
+
+/*
+    Task of the threads: every thread plays every thread_count-th rollout on its board.
+    Rollout k belongs to candidate k / rollouts and uses the sample seed k % rollouts.
+*/
+static void run_rollouts(void* context, int thread_index, int thread_count)
+{
+    struct RolloutSearch* search = context;
+    struct RolloutThread* thread = &search->threads[thread_index];
+    struct GameData* board = &thread->board;
+    int depth = search->config.depth;
+    int total = search->candidate_count * search->rollouts;
+    uint64_t nodes = 0;
+
+    for (int k = thread_index; k < total; k += thread_count) {
+        int candidate = k / search->rollouts;
+        int sample = k % search->rollouts;
+
+        gamedata_snapshot(search->game_data, board);
+        rng_seed(&board->rng, search->seed + (uint64_t)sample);
+        play_placement(board, search->root_list, search->candidates[candidate]);
+
+        float value = search->ratings[candidate];
+        int placed = 0;
+        while (!board->is_defeat && placed < depth) {
+            float rating;
+            int best = best_placement(search, &thread->ratings, board, &rating);
+            if (best < 0) break;
+
+            nodes += thread->ratings.list.count;
+            play_placement(board, &thread->ratings.list, best);
+            value += rating;
+            placed++;
+        }
+        // an earlier defeat costs more, so no rollout gains from ending before it had to rate its boards
+        if (board->is_defeat || placed < depth) value += ROLLOUT_DEFEAT_PENALTY * (depth - placed + 1);
+
+        search->values[k] = value;
+    }
+
+    __atomic_fetch_add(&search->nodes, nodes, __ATOMIC_RELAXED);
+}
+
+/*
+    Helper function that keeps the best rated placements of the searched game as the candidates,
+    on equal ratings the one with the lower index.
+*/
+static void select_candidates(struct RolloutSearch* search, const struct GameData* game_data, int count)
+{
+    struct PlacementRatings* ratings = &search->threads[0].ratings;
+    int capacity = search->config.candidates;
+
+    search->candidate_count = 0;
+    for (int first = 0; first < count; first += EVAL_CHUNK) {
+        int chunk = (count - first < EVAL_CHUNK) ? count - first : EVAL_CHUNK;
+
+        rate_placements(&search->evaluator, game_data, search->root_list, first, chunk, ratings);
+        for (int i = 0; i < chunk; i++) {
+            float rating = ratings->scores[i];
+            int index = search->candidate_count;
+
+            if (index == capacity) {
+                if (rating <= search->ratings[capacity - 1]) continue;
+                index--;
+            } else {
+                search->candidate_count++;
+            }
+            // insertion into the sorted candidates
+            while (index > 0 && search->ratings[index - 1] < rating) {
+                search->ratings[index] = search->ratings[index - 1];
+                search->candidates[index] = search->candidates[index - 1];
+                index--;
+            }
+            search->ratings[index] = rating;
+            search->candidates[index] = first + i;
+        }
+    }
+    search->nodes += count;
+}
+
+int rollout_search_best(struct RolloutSearch* search, const struct GameData* game_data)
+{
+    search->nodes = 0;
+    search->candidate_count = 0;
+
+    if (game_data->is_defeat) return -1;
+
+    int count = generate_placements(game_data, search->root_list);
+    if (count == 0) return -1;
+
+    select_candidates(search, game_data, count);
+    if (search->candidate_count == 1) {
+        search->means[0] = search->ratings[0];
+        return search->candidates[0];
+    }
+
+    search->game_data = game_data;
+    search->seed = search->config.seed ^ get_gamedata_hash(game_data);
+    search->rollouts = search->config.samples / search->candidate_count;
+    thread_pool_run(&search->pool, run_rollouts, search);
+
+    int best = 0;
+    for (int candidate = 0; candidate < search->candidate_count; candidate++) {
+        const float* values = search->values + (size_t)candidate * search->rollouts;
+        double sum = 0.0;
+
+        for (int sample = 0; sample < search->rollouts; sample++) sum += values[sample];
+        search->means[candidate] = (float)(sum / search->rollouts);
+
+        if (search->means[candidate] > search->means[best]) best = candidate;
+    }
+    return search->candidates[best];
+}
+
+bool rollout_search_play(struct RolloutSearch* search, struct GameData* game_data)
+{
+    int placement = rollout_search_best(search, game_data);
+    if (placement < 0) return false;
+
+    play_placement(game_data, search->root_list, placement);
+    return true;
+}
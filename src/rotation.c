@@ -0,0 +1,58 @@
+#include "rotation.h"
+
+/*
+    SRS kick tables, source: https://tetris.wiki/Super_Rotation_System
+    The y offsets are negated compared to the source, because y points downwards in the arena.
+*/
+
+// J, L, S, T and Z pieces, indexed by the SRS state the piece rotates from and the direction (clockwise, counter-clockwise)
+static const struct KickList JLSTZ_KICKS[PIECE_ROTATIONS][2] = {
+    { { 5, { { 0, 0 }, { -1, 0 }, { -1, -1 }, { 0, 2 }, { -1, 2 } } },  // 0 -> R
+      { 5, { { 0, 0 }, { 1, 0 }, { 1, -1 }, { 0, 2 }, { 1, 2 } } } },  // 0 -> L
+    { { 5, { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, -2 }, { 1, -2 } } },  // R -> 2
+      { 5, { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, -2 }, { 1, -2 } } } },  // R -> 0
+    { { 5, { { 0, 0 }, { 1, 0 }, { 1, -1 }, { 0, 2 }, { 1, 2 } } },  // 2 -> L
+      { 5, { { 0, 0 }, { -1, 0 }, { -1, -1 }, { 0, 2 }, { -1, 2 } } } },  // 2 -> R
+    { { 5, { { 0, 0 }, { -1, 0 }, { -1, 1 }, { 0, -2 }, { -1, -2 } } },  // L -> 0
+      { 5, { { 0, 0 }, { -1, 0 }, { -1, 1 }, { 0, -2 }, { -1, -2 } } } },  // L -> 2
+};
+
+// I piece, indexed by the SRS state the piece rotates from and the direction (clockwise, counter-clockwise)
+static const struct KickList I_KICKS[PIECE_ROTATIONS][2] = {
+    { { 5, { { 0, 0 }, { -2, 0 }, { 1, 0 }, { -2, 1 }, { 1, -2 } } },  // 0 -> R
+      { 5, { { 0, 0 }, { -1, 0 }, { 2, 0 }, { -1, -2 }, { 2, 1 } } } },  // 0 -> L
+    { { 5, { { 0, 0 }, { -1, 0 }, { 2, 0 }, { -1, -2 }, { 2, 1 } } },  // R -> 2
+      { 5, { { 0, 0 }, { 2, 0 }, { -1, 0 }, { 2, -1 }, { -1, 2 } } } },  // R -> 0
+    { { 5, { { 0, 0 }, { 2, 0 }, { -1, 0 }, { 2, -1 }, { -1, 2 } } },  // 2 -> L
+      { 5, { { 0, 0 }, { 1, 0 }, { -2, 0 }, { 1, 2 }, { -2, -1 } } } },  // 2 -> R
+    { { 5, { { 0, 0 }, { 1, 0 }, { -2, 0 }, { 1, 2 }, { -2, -1 } } },  // L -> 0
+      { 5, { { 0, 0 }, { -2, 0 }, { 1, 0 }, { -2, 1 }, { 1, -2 } } } },  // L -> 2
+};
+
+// the O piece doesn't change its shape when rotated, so it is never kicked
+static const struct KickList NO_KICKS = { 1, { { 0, 0 } } };
+
+/*
+    The rotation 0 of the pieces in pieces.h isn't the SRS spawn state of every piece.
+    Both rotate the piece matrix around its center, so they only differ by a fixed number of rotations.
+    SRS state = (rotation + SRS_STATE_OFFSET[piece]) % 4
+*/
+static const int SRS_STATE_OFFSET[PIECE_TYPES] = {
+    [PIECE_O] = 0,
+    [PIECE_L] = 1,
+    [PIECE_J] = 3,
+    [PIECE_T] = 2,
+    [PIECE_I] = 1,
+    [PIECE_Z] = 2,
+    [PIECE_S] = 2,
+};
+
+const struct KickList* get_rotation_kicks(enum RotationSystem system, enum Piece piece, int from_rotation, bool clockwise)
+{
+    if (system != ROTATION_SRS || piece == PIECE_O) return &NO_KICKS;
+
+    int state = (from_rotation + SRS_STATE_OFFSET[piece]) % PIECE_ROTATIONS;
+    int dir = clockwise ? 0 : 1;
+
+    return (piece == PIECE_I) ? &I_KICKS[state][dir] : &JLSTZ_KICKS[state][dir];
+}
@@ -0,0 +1,102 @@
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "thread_pool.h"
+#include "engine.h"
+
+static void* worker_main(void* argument)
+{
+    struct ThreadPoolWorker* worker = argument;
+    struct ThreadPool* pool = worker->pool;
+    unsigned generation = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == generation) pthread_cond_wait(&pool->start, &pool->mutex);
+        if (pool->shutdown) break;
+
+        generation = pool->generation;
+        thread_pool_task_t task = pool->task;
+        void* context = pool->context;
+        int thread_count = pool->thread_count;
+        pthread_mutex_unlock(&pool->mutex);
+
+        task(context, worker->thread, thread_count);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->running == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+bool init_thread_pool(struct ThreadPool* pool, int thread_count)
+{
+    if (thread_count < 1) thread_count = 1;
+    if (thread_count > THREAD_POOL_MAX_THREADS) thread_count = THREAD_POOL_MAX_THREADS;
+
+    pool->thread_count = 1;
+    pool->task = NULL;
+    pool->context = NULL;
+    pool->generation = 0;
+    pool->running = 0;
+    pool->shutdown = false;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for (int thread = 1; thread < thread_count; thread++) {
+        struct ThreadPoolWorker* worker = &pool->workers[thread];
+        worker->pool = pool;
+        worker->thread = thread;
+
+        if (pthread_create(&worker->handle, NULL, worker_main, worker) != 0) return false;
+        pool->thread_count++;
+    }
+    return true;
+}
+
+void thread_pool_run(struct ThreadPool* pool, thread_pool_task_t task, void* context)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->task = task;
+    pool->context = context;
+    pool->running = pool->thread_count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+
+    task(context, 0, pool->thread_count);
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->running > 0) pthread_cond_wait(&pool->done, &pool->mutex);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void destroy_thread_pool(struct ThreadPool* pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int thread = 1; thread < pool->thread_count; thread++) pthread_join(pool->workers[thread].handle, NULL);
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    pool->thread_count = 1;
+}
+
+int get_processor_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count < 1) ? 1 : (int)count;
+}
+
+void* allocate_aligned(size_t count, size_t size)
+{
+    size_t bytes = (count * size + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    return aligned_alloc(CACHE_LINE_SIZE, bytes);
+}
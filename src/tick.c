@@ -0,0 +1,132 @@
+#include "tick.h"
+
+/*
+    Helper function that checks whether the current piece rests on the ground or on other blocks.
+*/
+static bool is_grounded(const struct GameData* game_data)
+{
+    return piece_collides(game_data, game_data->current_piece, game_data->rotation, game_data->position_x, game_data->position_y + 1);
+}
+
+/*
+    Helper function that locks the current piece where it is and restarts the timers for the next piece.
+    The piece rests on the ground, so the hard drop doesn't move it.
+*/
+static size_t lock_current_piece(struct GameData* game_data)
+{
+    game_data->ticks.gravity_fraction = 0;
+    game_data->ticks.lock_timer = 0;
+    game_data->ticks.lock_resets = 0;
+
+    return hard_drop(game_data);
+}
+
+/*
+    Helper function that applies delayed auto shift: a side button moves once when it is pressed,
+    then after das ticks it moves every arr ticks, or straight to the wall when arr is 0.
+*/
+static void shift_sideways(struct GameData* game_data, unsigned inputs, unsigned pressed)
+{
+    struct TickState* ticks = &game_data->ticks;
+    const struct Handling* handling = &game_data->handling;
+
+    unsigned side = inputs & (INPUT_LEFT | INPUT_RIGHT);
+    if (side == (INPUT_LEFT | INPUT_RIGHT)) side = INPUT_RIGHT;
+
+    if (side == 0) {
+        ticks->side_timer = 0;
+        return;
+    }
+
+    enum Direction dir = (side == INPUT_LEFT) ? LEFT : RIGHT;
+    if (pressed & side) {
+        ticks->side_timer = 0;
+        move(game_data, dir);
+        return;
+    }
+
+    uint32_t held = ++ticks->side_timer;
+    if (held < handling->das) return;
+
+    if (handling->arr == 0) {
+        int position_x;
+        do {
+            position_x = game_data->position_x;
+            move(game_data, dir);
+        } while (game_data->position_x != position_x);
+    }
+    else if ((held - handling->das) % handling->arr == 0) {
+        move(game_data, dir);
+    }
+}
+
+BOARD_INLINE size_t game_tick_rules(struct GameData* game_data, unsigned inputs, const struct RuleSet* rules)
+{
+    struct TickState* ticks = &game_data->ticks;
+    const struct Handling* handling = &game_data->handling;
+    unsigned pressed = inputs & ~ticks->held_inputs;
+
+    ticks->tick++;
+    ticks->held_inputs = inputs & INPUT_HELD_MASK;
+
+    // remember the state of the piece to find out whether the inputs moved it
+    int rotation = game_data->rotation;
+    int position_x = game_data->position_x;
+    int position_y = game_data->position_y;
+
+    if (inputs & INPUT_ROTATE_RIGHT) rotate_piece(game_data, RIGHT);
+    if (inputs & INPUT_ROTATE_LEFT)  rotate_piece(game_data, LEFT);
+    shift_sideways(game_data, inputs, pressed);
+
+    if (inputs & INPUT_HARD_DROP) return lock_current_piece(game_data);
+
+    bool moved = game_data->rotation != rotation || game_data->position_x != position_x || game_data->position_y != position_y;
+
+    // gravity moves the piece down by whole cells, the rest is carried over to the next tick
+    game_data->fast_drop = (inputs & INPUT_SOFT_DROP) != 0;
+    uint32_t gravity = rules->gravity(game_data->level);
+    if (game_data->fast_drop && handling->soft_drop_factor > 1) {
+        gravity = (gravity > GRAVITY_MAX / handling->soft_drop_factor) ? GRAVITY_MAX : gravity * handling->soft_drop_factor;
+    }
+
+    ticks->gravity_fraction += gravity;
+    int cells = ticks->gravity_fraction >> GRAVITY_SHIFT;
+    ticks->gravity_fraction &= GRAVITY_ONE - 1;
+
+    int fallen = fall(game_data, cells);
+
+    if (!is_grounded(game_data)) {
+        ticks->lock_timer = 0;
+        return 0;
+    }
+
+    // moving a piece on the ground restarts its lock delay, but only lock_resets times
+    if (moved && ticks->lock_resets < handling->lock_resets) {
+        ticks->lock_timer = 0;
+        ticks->lock_resets++;
+    }
+
+    // without a lock delay the piece locks when gravity pushes it into the ground
+    if (handling->lock_delay == 0) return (cells > fallen) ? lock_current_piece(game_data) : 0;
+
+    return (++ticks->lock_timer >= handling->lock_delay) ? lock_current_piece(game_data) : 0;
+}
+
+size_t game_tick(struct GameData* game_data, unsigned inputs)
+{
+    return WITH_RULE_SET(game_data, game_tick_rules, game_data, inputs);
+}
+
+int frame_ticks(double* accumulator, double frame_time)
+{
+    int ticks = 0;
+
+    *accumulator += frame_time;
+    if (*accumulator > MAX_TICKS_PER_FRAME * TICK_TIME) *accumulator = MAX_TICKS_PER_FRAME * TICK_TIME;
+
+    while (*accumulator >= TICK_TIME) {
+        *accumulator -= TICK_TIME;
+        ticks++;
+    }
+    return ticks;
+}
@@ -0,0 +1,127 @@
+#include "undo.h"
+
+void gamedata_snapshot(const struct GameData* game_data, struct GameData* snapshot)
+{
+    *snapshot = *game_data;
+}
+
+void gamedata_restore(struct GameData* game_data, const struct GameData* snapshot)
+{
+    *game_data = *snapshot;
+}
+
+void init_undo_stack(struct UndoStack* stack)
+{
+    stack->top = 0;
+    stack->count = 0;
+}
+
+/*
+    Helper function that pushes the state of the game before the current piece locks with its position_y at landing_row.
+    The rows which will be cleared are found by testing the touched rows with the blocks of the piece added.
+*/
+static void record_lock(struct UndoStack* stack, const struct GameData* game_data, int landing_row)
+{
+    struct UndoEntry* entry = &stack->entries[stack->top];
+    stack->top = (stack->top + 1) % UNDO_STACK_CAPACITY;
+    if (stack->count < UNDO_STACK_CAPACITY) stack->count++;
+
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, game_data->rotation);
+    int width = game_data->width;
+
+    entry->piece = game_data->current_piece;
+    entry->rotation = game_data->rotation;
+    entry->position_x = game_data->position_x;
+    entry->position_y = game_data->position_y;
+
+    int first_row = landing_row + shape->min_y;
+    int last_row  = landing_row + shape->max_y;
+    if (first_row < 0) first_row = 0;
+    if (last_row >= game_data->height) last_row = game_data->height - 1;
+
+    entry->first_row = first_row;
+    entry->row_count = (last_row >= first_row) ? last_row - first_row + 1 : 0;
+    entry->cleared_count = 0;
+    for (int i = 0; i < entry->row_count; i++) {
+        int row = first_row + i;
+        arena_row_t piece_row = shift_piece_row(shape->row_masks[row - landing_row], game_data->position_x);
+
+        entry->rows[i] = game_data->arena_rows[row];
+        memcpy(entry->colors[i], game_data->arena + row * width, width);
+        if ((entry->rows[i] | piece_row) == full_row_mask(width)) entry->cleared_rows[entry->cleared_count++] = row;
+    }
+
+    entry->features = game_data->features;
+    entry->preview = game_data->preview;
+    entry->randomizer = game_data->randomizer;
+    entry->rng = game_data->rng;
+
+    entry->score = game_data->score;
+    entry->level = game_data->level;
+    entry->cleared_lines = game_data->cleared_lines;
+    entry->is_defeat = game_data->is_defeat;
+    entry->last_lock_rows = game_data->last_lock_rows;
+    entry->arena_hash = game_data->arena_hash;
+    entry->hash = game_data->hash;
+}
+
+size_t drop_with_undo(struct GameData* game_data, struct UndoStack* stack)
+{
+    if (piece_collides(game_data, game_data->current_piece, game_data->rotation, game_data->position_x, game_data->position_y + 1)) {
+        record_lock(stack, game_data, game_data->position_y);
+    }
+    return drop(game_data);
+}
+
+size_t hard_drop_with_undo(struct GameData* game_data, struct UndoStack* stack)
+{
+    record_lock(stack, game_data, get_ghost_row(game_data));
+    return hard_drop(game_data);
+}
+
+bool undo_lock(struct GameData* game_data, struct UndoStack* stack)
+{
+    if (stack->count == 0) return false;
+
+    stack->top = (stack->top + UNDO_STACK_CAPACITY - 1) % UNDO_STACK_CAPACITY;
+    stack->count--;
+    const struct UndoEntry* entry = &stack->entries[stack->top];
+    int width = game_data->width;
+
+    // the piece spawned after the lock is handed back to the preview with the restored queue
+    game_data->piece_count[game_data->current_piece]--;
+
+    // put the cleared rows back in reverse order, moving the rows above them up by one
+    for (int i = entry->cleared_count - 1; i >= 0; i--) {
+        int row = entry->cleared_rows[i];
+
+        memmove(game_data->arena_rows, game_data->arena_rows + 1, sizeof(game_data->arena_rows[0]) * row);
+        memmove(game_data->arena, game_data->arena + width, sizeof(game_data->arena[0]) * width * row);
+    }
+
+    // now every touched row is back at its index and gets the content it had before the lock
+    for (int i = 0; i < entry->row_count; i++) {
+        game_data->arena_rows[entry->first_row + i] = entry->rows[i];
+        memcpy(game_data->arena + (entry->first_row + i) * width, entry->colors[i], width);
+    }
+
+    game_data->current_piece = entry->piece;
+    game_data->rotation = entry->rotation;
+    game_data->position_x = entry->position_x;
+    game_data->position_y = entry->position_y;
+
+    game_data->features = entry->features;
+    game_data->preview = entry->preview;
+    game_data->randomizer = entry->randomizer;
+    game_data->rng = entry->rng;
+
+    game_data->score = entry->score;
+    game_data->level = entry->level;
+    game_data->cleared_lines = entry->cleared_lines;
+    game_data->is_defeat = entry->is_defeat;
+    game_data->last_lock_rows = entry->last_lock_rows;
+    game_data->arena_hash = entry->arena_hash;
+    game_data->hash = entry->hash;
+
+    return true;
+}
@@ -10,39 +10,27 @@ void update_gl(GLFWwindow* window)
 
     switch (user_data->gameData.gameState) {
         case PLAYING: {
-            // accumulate delta time
-            user_data->time_since_last_drop += delta_time;
+            // run as many fixed ticks as fit into the elapsed time, the rest is carried over to the next frame
+            int ticks = frame_ticks(&user_data->tick_accumulator, delta_time);
 
-            if (user_data->holding_left || user_data->holding_right) user_data->time_since_last_side_move += delta_time;
-            else user_data->time_since_last_side_move = 0.0;
-
-            // drop piece
-            if ((!user_data->gameData.fast_drop && (user_data->time_since_last_drop >= calc_drop_time(&user_data->gameData))) ||
-                (user_data->gameData.fast_drop && user_data->time_since_last_drop >= FAST_DROP_TIME)) {
-                size_t cleared_rows = drop(&user_data->gameData);
+            for (int tick = 0; tick < ticks; tick++) {
+                size_t cleared_rows = game_tick(&user_data->gameData, user_data->held_inputs | user_data->pressed_inputs);
+                user_data->pressed_inputs = 0;
 
                 if (cleared_rows == 4) queue_audio_if_empty(user_data->effect_device, user_data->wav_data[2]);
-                user_data->time_since_last_drop = 0.0;
 
                 if (user_data->gameData.is_defeat) {
                     queue_audio_if_empty(user_data->effect_device, user_data->wav_data[1]);
                     user_data->gameData.gameState = GAME_OVER;
+                    break;
                 }
             }
-
-            // move sideways
-            if (user_data->time_since_last_side_move >= MOVE_SIDE_WAYS_TIME) {
-                enum Direction dir;
-
-                if (user_data->holding_left)  dir = LEFT;
-                if (user_data->holding_right) dir = RIGHT;
-
-                move(&user_data->gameData, dir);
-
-                user_data->time_since_last_side_move -= MOVE_SIDE_WAYS_TIME;
-            }
             break;
         }
+        default:
+            user_data->tick_accumulator = 0.0;
+            user_data->pressed_inputs = 0;
+            break;
     }
     user_data->last_frame_time = frame_time;
 
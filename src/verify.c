@@ -0,0 +1,943 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "verify.h"
+#include "batch.h"
+#include "env.h"
+#include "evaluator.h"
+#include "movegen.h"
+#include "observation.h"
+#include "tick.h"
+#include "undo.h"
+
+/*
+    The arenas the checks play on: the standard ones of the rule sets and a narrow one,
+    where random placements clear rows often.
+*/
+static const struct {
+    enum RuleSetType rule_set;
+    int width;
+    int height;
+} VERIFY_CONFIGS[] = {
+    { RULES_CLASSIC,   ARENA_WIDTH, ARENA_HEIGHT },
+    { RULES_GUIDELINE, ARENA_WIDTH, ARENA_HEIGHT },
+    { RULES_GUIDELINE, 4, 8 },
+};
+
+#define VERIFY_CONFIG_COUNT (sizeof(VERIFY_CONFIGS) / sizeof(VERIFY_CONFIGS[0]))
+#define VERIFY_SEEDS 50
+
+static struct GameConfig verify_config(size_t index)
+{
+    struct GameConfig config = rule_set_config(VERIFY_CONFIGS[index].rule_set);
+    config.width = VERIFY_CONFIGS[index].width;
+    config.height = VERIFY_CONFIGS[index].height;
+
+    return config;
+}
+
+/*
+    Helper function that compares the board features of two games field by field.
+*/
+static bool same_features(const struct BoardFeatures* a, const struct BoardFeatures* b, int width, int height)
+{
+    for (int x = 0; x < width; x++) {
+        if (a->column_masks[x] != b->column_masks[x] || a->column_heights[x] != b->column_heights[x]
+            || a->column_holes[x] != b->column_holes[x] || a->well_depths[x] != b->well_depths[x]) return false;
+    }
+    for (int y = 0; y < height; y++) {
+        if (a->row_fill[y] != b->row_fill[y]) return false;
+    }
+    return a->aggregate_height == b->aggregate_height && a->max_height == b->max_height && a->holes == b->holes
+        && a->bumpiness == b->bumpiness && a->wells == b->wells;
+}
+
+/*
+    Helper function that compares everything a lock changes: the arena with its colors and features,
+    the hashes, the counters and the current piece.
+*/
+static bool same_state(const struct GameData* a, const struct GameData* b)
+{
+    int width = a->width;
+    int height = a->height;
+
+    return memcmp(a->arena_rows, b->arena_rows, sizeof(arena_row_t) * height) == 0
+        && memcmp(a->arena, b->arena, (size_t)width * height) == 0
+        && same_features(&a->features, &b->features, width, height)
+        && a->arena_hash == b->arena_hash && a->hash == b->hash
+        && a->score == b->score && a->cleared_lines == b->cleared_lines && a->level == b->level
+        && a->is_defeat == b->is_defeat && a->current_piece == b->current_piece && a->rotation == b->rotation
+        && a->position_x == b->position_x && a->position_y == b->position_y
+        && memcmp(a->piece_count, b->piece_count, sizeof(a->piece_count)) == 0;
+}
+
+/*
+    Counts of the comparisons of the incremental hash of a game with calc_gamedata_hash.
+*/
+struct HashChecks {
+    uint64_t count;
+    int failures;
+};
+
+/*
+    Helper function that compares the hash the engine keeps up to date with the one computed from scratch.
+*/
+static void check_hash(const struct GameData* game_data, const char* action, struct HashChecks* checks)
+{
+    checks->count++;
+    if (get_gamedata_hash(game_data) == calc_gamedata_hash(game_data)) return;
+
+    if (checks->failures < 10) {
+        printf("hash %016" PRIx64 " after %s differs from %016" PRIx64 " (rules %s %dx%d)\n",
+               get_gamedata_hash(game_data), action, calc_gamedata_hash(game_data),
+               game_data->rules.name, game_data->width, game_data->height);
+    }
+    checks->failures++;
+}
+
+/*
+    Helper function that moves the current piece to a random placement without locking it.
+    Placements that clear rows are preferred, so that line clears are covered as well.
+    Returns false when the piece has no placement.
+*/
+static bool move_to_random_placement(struct GameData* game_data, struct PlacementList* list, struct Rng* rng,
+                                     struct HashChecks* checks)
+{
+    static const char* const STEP_NAMES[] = { "move left", "move right", "rotation right", "rotation left", "fall" };
+
+    uint8_t steps[PLACEMENT_MAX_NODES];
+    int clearing[PLACEMENT_MAX_NODES];
+    int clearing_count = 0;
+
+    int count = generate_placements(game_data, list);
+    if (count == 0) return false;
+
+    for (int i = 0; i < count; i++) {
+        const struct Placement* placement = &list->placements[i];
+        if (eroded_piece_cells(game_data->arena_rows, game_data->width, game_data->current_piece,
+                               placement->rotation, placement->position_x, placement->position_y) > 0) {
+            clearing[clearing_count++] = i;
+        }
+    }
+
+    int index = (clearing_count > 0) ? clearing[rng_range(rng, clearing_count)] : (int)rng_range(rng, count);
+    int length = get_placement_path(list, index, steps, PLACEMENT_MAX_NODES);
+    for (int i = 0; i < length; i++) {
+        play_placement_step(game_data, steps[i]);
+        check_hash(game_data, STEP_NAMES[steps[i]], checks);
+    }
+
+    return true;
+}
+
+int verify_undo(void)
+{
+    static struct PlacementList list;
+    static struct UndoStack stack;
+    static struct GameData before[UNDO_STACK_CAPACITY];   // the game right before every lock
+    struct HashChecks checks = { 0, 0 };
+    uint64_t locks = 0;
+    uint64_t lines = 0;
+    int failures = 0;
+
+    for (size_t i = 0; i < VERIFY_CONFIG_COUNT; i++) {
+        struct GameConfig config = verify_config(i);
+
+        for (uint32_t seed = 1; seed <= VERIFY_SEEDS; seed++) {
+            struct GameData game_data = init_gamedata_with_config(seed, &config);
+            struct GameData end;
+            struct Rng rng;
+            int count = 0;
+
+            rng_seed(&rng, seed);
+            init_undo_stack(&stack);
+
+            // every other piece is hard dropped at a placement, the others are shifted sideways and fall row by row
+            while (count < UNDO_STACK_CAPACITY && !game_data.is_defeat) {
+                if (count % 2 == 0) {
+                    if (!move_to_random_placement(&game_data, &list, &rng, &checks)) break;
+
+                    gamedata_snapshot(&game_data, &before[count]);
+                    size_t rows = hard_drop_with_undo(&game_data, &stack);
+                    check_hash(&game_data, (rows > 0) ? "line clear" : "lock", &checks);
+                }
+                else {
+                    int rotations = (int)rng_range(&rng, PIECE_ROTATIONS);
+                    for (int step = 0; step < rotations; step++) {
+                        rotate_piece(&game_data, LEFT);
+                        check_hash(&game_data, "rotation left", &checks);
+                    }
+                    int shift = (int)rng_range(&rng, game_data.width) - game_data.width / 2;
+                    for (int step = 0; step < abs(shift); step++) {
+                        move(&game_data, (shift < 0) ? LEFT : RIGHT);
+                        check_hash(&game_data, "side move", &checks);
+                    }
+
+                    while (!piece_collides(&game_data, game_data.current_piece, game_data.rotation,
+                                           game_data.position_x, game_data.position_y + 1)) {
+                        drop_with_undo(&game_data, &stack);
+                        check_hash(&game_data, "drop", &checks);
+                    }
+                    gamedata_snapshot(&game_data, &before[count]);
+                    size_t rows = drop_with_undo(&game_data, &stack);
+                    check_hash(&game_data, (rows > 0) ? "line clear" : "lock", &checks);
+                }
+                count++;
+            }
+
+            locks += count;
+            lines += game_data.cleared_lines;
+            gamedata_snapshot(&game_data, &end);
+
+            for (int lock = count - 1; lock >= 0; lock--) {
+                bool undone = undo_lock(&game_data, &stack);
+                check_hash(&game_data, "undo", &checks);
+
+                if (!undone || !same_state(&game_data, &before[lock])) {
+                    if (failures < 10) {
+                        printf("undo of lock %d seed %u rules %s %dx%d doesn't restore the game\n",
+                               lock, seed, game_data.rules.name, game_data.width, game_data.height);
+                    }
+                    failures++;
+                    break;
+                }
+            }
+            if (undo_lock(&game_data, &stack)) failures++;
+
+            gamedata_restore(&game_data, &end);
+            if (!same_state(&game_data, &end)) failures++;
+        }
+    }
+
+    printf("%s: %d undo failures in %" PRIu64 " locks with %" PRIu64 " cleared lines\n",
+           (failures == 0) ? "passed" : "FAILED", failures, locks, lines);
+    printf("%s: %d of %" PRIu64 " incremental hashes wrong\n",
+           (checks.failures == 0) ? "passed" : "FAILED", checks.failures, checks.count);
+    return failures + checks.failures;
+}
+
+/*
+    Helper function that runs frames of the given length and returns the number of ticks simulated for them.
+*/
+static int run_frames(double* accumulator, double frame_time, int frames)
+{
+    int ticks = 0;
+    for (int frame = 0; frame < frames; frame++) ticks += frame_ticks(accumulator, frame_time);
+    return ticks;
+}
+
+// a stall of a second only catches up MAX_TICKS_PER_FRAME ticks and drops the rest of the time
+static bool tick_case_stall(void)
+{
+    double accumulator = 0.0;
+    return frame_ticks(&accumulator, 1.0) == MAX_TICKS_PER_FRAME && accumulator < TICK_TIME
+        && frame_ticks(&accumulator, TICK_TIME) == 1;
+}
+
+// a frame rate equal to the tick rate runs one tick per frame
+static bool tick_case_tick_rate(void)
+{
+    double accumulator = 0.0;
+    return run_frames(&accumulator, TICK_TIME, TICK_RATE * 10) == TICK_RATE * 10;
+}
+
+// at half the tick rate every frame runs two ticks
+static bool tick_case_slow_frames(void)
+{
+    double accumulator = 0.0;
+    for (int frame = 0; frame < TICK_RATE; frame++) {
+        if (frame_ticks(&accumulator, 2 * TICK_TIME) != 2) return false;
+    }
+    return true;
+}
+
+// faster frames than ticks carry the time over, a second of them still runs a second of ticks
+static bool tick_case_fast_frames(void)
+{
+    double accumulator = 0.0;
+    int ticks = run_frames(&accumulator, 1.0 / 144, 144);
+    return ticks >= TICK_RATE - 1 && ticks <= TICK_RATE;
+}
+
+/*
+    Helper function that plays a game with random inputs for the given number of ticks.
+*/
+static void play_random_ticks(struct GameData* game_data, uint64_t seed, int ticks)
+{
+    struct Rng rng;
+    rng_seed(&rng, seed);
+
+    for (int tick = 0; tick < ticks && !game_data->is_defeat; tick++) {
+        game_tick(game_data, (unsigned)rng_range(&rng, INPUT_HARD_DROP << 1));
+    }
+}
+
+// the same seed and inputs always end in the same game, whatever the frames were
+static bool tick_case_replay(void)
+{
+    for (size_t i = 0; i < VERIFY_CONFIG_COUNT; i++) {
+        struct GameConfig config = verify_config(i);
+
+        for (uint32_t seed = 1; seed <= VERIFY_SEEDS; seed++) {
+            struct GameData first = init_gamedata_with_config(seed, &config);
+            struct GameData second = init_gamedata_with_config(seed, &config);
+
+            play_random_ticks(&first, seed, 2000);
+            play_random_ticks(&second, seed, 2000);
+            if (!same_state(&first, &second) || first.ticks.tick != second.ticks.tick) return false;
+        }
+    }
+    return true;
+}
+
+/*
+    Helper function that starts a guideline game on an arena wide enough that side moves don't reach the wall
+    for a while. At level 1 the piece falls one row per second, the cases below are decided long before.
+*/
+static struct GameData init_tick_game(uint16_t das, uint16_t arr)
+{
+    struct GameConfig config = rule_set_config(RULES_GUIDELINE);
+    config.width = 40;
+    config.handling.das = das;
+    config.handling.arr = arr;
+
+    return init_gamedata_with_config(1, &config);
+}
+
+/*
+    Helper function that returns the column the current piece stops at when it is moved left as far as possible.
+*/
+static int left_wall_column(const struct GameData* game_data)
+{
+    struct GameData copy = *game_data;
+    int position_x;
+    do {
+        position_x = copy.position_x;
+        move(&copy, LEFT);
+    } while (copy.position_x != position_x);
+
+    return copy.position_x;
+}
+
+static int pieces_played(const struct GameData* game_data)
+{
+    int count = 0;
+    for (int piece = 0; piece < PIECE_TYPES; piece++) count += game_data->piece_count[piece];
+    return count;
+}
+
+/*
+    Helper function that holds left and checks that the piece moves when the button is pressed in tick 1,
+    again in tick 1 + das and then every arr ticks, or to the wall in tick 1 + das when arr is 0.
+*/
+static bool run_auto_shift(uint16_t das, uint16_t arr)
+{
+    struct GameData game_data = init_tick_game(das, arr);
+    int start_x = game_data.position_x;
+    int wall_x = left_wall_column(&game_data);
+
+    for (int tick = 1; tick <= das + 20; tick++) {
+        int moves = 1;
+        if (tick >= 1 + das) moves = (arr == 0) ? start_x - wall_x : 2 + (tick - 1 - das) / arr;
+
+        game_tick(&game_data, INPUT_LEFT);
+        int expected_x = (start_x - moves > wall_x) ? start_x - moves : wall_x;
+        if (game_data.position_x != expected_x) return false;
+    }
+    return true;
+}
+
+// das 10 and arr 2 of the guideline config: moves in tick 1, 11, 13, 15, ...
+static bool tick_case_das_arr(void)
+{
+    return run_auto_shift(10, 2) && run_auto_shift(16, 6) && run_auto_shift(1, 1);
+}
+
+// arr 0 moves the piece to the wall when das is over
+static bool tick_case_arr_zero(void)
+{
+    return run_auto_shift(10, 0);
+}
+
+/*
+    Helper function that puts the current piece on the ground and returns the tick it locks in,
+    alternating left and right presses in the first moving_ticks ticks.
+*/
+static int lock_tick(int moving_ticks)
+{
+    struct GameData game_data = init_tick_game(10, 2);
+    int pieces = pieces_played(&game_data);
+
+    fall(&game_data, get_ghost_row(&game_data) - game_data.position_y);
+
+    for (int tick = 1; tick <= 1000; tick++) {
+        unsigned inputs = 0;
+        if (tick <= moving_ticks) inputs = (tick % 2 == 1) ? INPUT_LEFT : INPUT_RIGHT;
+
+        game_tick(&game_data, inputs);
+        if (pieces_played(&game_data) != pieces) return tick;
+    }
+    return -1;
+}
+
+// a piece resting on the ground locks after lock_delay ticks
+static bool tick_case_lock_delay(void)
+{
+    struct Handling handling = rule_set_config(RULES_GUIDELINE).handling;
+    return lock_tick(0) == handling.lock_delay;
+}
+
+// moves on the ground restart the lock delay lock_resets times, the piece locks lock_delay - 1 ticks after the last one
+static bool tick_case_lock_resets(void)
+{
+    struct Handling handling = rule_set_config(RULES_GUIDELINE).handling;
+    return lock_tick(1000) == handling.lock_resets + handling.lock_delay - 1
+        && lock_tick(5) == 5 + handling.lock_delay - 1;
+}
+
+static uint32_t gravity_20g(uint32_t level)
+{
+    (void)level;
+    return gravity_from_seconds(0.0);
+}
+
+static uint32_t gravity_every_third_tick(uint32_t level)
+{
+    (void)level;
+    return gravity_from_seconds(3 * TICK_TIME);
+}
+
+/*
+    Helper function that starts a guideline game on the standard arena with the given gravity.
+*/
+static struct GameData init_gravity_game(uint32_t (*gravity)(uint32_t level))
+{
+    struct RuleSet rules = GUIDELINE_RULES;
+    rules.name = "custom";
+    rules.gravity = gravity;
+
+    struct GameConfig config = rule_set_config(RULES_GUIDELINE);
+    config.rule_set = RULES_CUSTOM;
+    config.custom_rules = &rules;
+
+    return init_gamedata_with_config(1, &config);
+}
+
+// 20G puts every new piece on its ghost row in its first tick, the lock delay still runs
+static bool tick_case_20g(void)
+{
+    struct GameData game_data = init_gravity_game(gravity_20g);
+    if (gravity_from_seconds(0.0) != GRAVITY_MAX || game_data.rule_set != RULES_CUSTOM) return false;
+
+    for (int piece = 0; piece < 5 && !game_data.is_defeat; piece++) {
+        int pieces = pieces_played(&game_data);
+        int ghost_row = get_ghost_row(&game_data);
+
+        game_tick(&game_data, 0);
+        if (game_data.position_y != ghost_row || pieces_played(&game_data) != pieces) return false;
+
+        game_tick(&game_data, INPUT_HARD_DROP);
+        if (pieces_played(&game_data) != pieces + 1) return false;
+    }
+    return true;
+}
+
+// gravity of one cell per three ticks moves the piece in tick 3, 6, 9, ...
+static bool tick_case_slow_gravity(void)
+{
+    struct GameData game_data = init_gravity_game(gravity_every_third_tick);
+    int start_y = game_data.position_y;
+
+    for (int tick = 1; tick <= 15; tick++) {
+        game_tick(&game_data, 0);
+        if (game_data.position_y != start_y + tick / 3) return false;
+    }
+    return true;
+}
+
+static const struct {
+    const char* name;
+    bool (*run)(void);
+} TICK_CASES[] = {
+    { "stall of a second",              tick_case_stall },
+    { "frames at the tick rate",        tick_case_tick_rate },
+    { "frames at half the tick rate",   tick_case_slow_frames },
+    { "frames at 144 Hz",               tick_case_fast_frames },
+    { "replay of random inputs",        tick_case_replay },
+    { "das and arr",                    tick_case_das_arr },
+    { "arr 0",                          tick_case_arr_zero },
+    { "lock delay",                     tick_case_lock_delay },
+    { "lock delay resets",              tick_case_lock_resets },
+    { "20G gravity",                    tick_case_20g },
+    { "gravity of a cell per 3 ticks",  tick_case_slow_gravity },
+};
+
+int verify_ticks(void)
+{
+    int count = sizeof(TICK_CASES) / sizeof(TICK_CASES[0]);
+    int failures = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (TICK_CASES[i].run()) continue;
+
+        printf("tick case \"%s\" failed\n", TICK_CASES[i].name);
+        failures++;
+    }
+
+    printf("%s: %d of %d tick cases failed\n", (failures == 0) ? "passed" : "FAILED", failures, count);
+    return failures;
+}
+
+/*
+    Helper function that plays an action of a batch on a game with the engine functions, followed by gravity.
+    Returns true when the piece was locked.
+*/
+static bool play_action(struct GameData* game_data, enum Action action)
+{
+    int pieces = pieces_played(game_data);
+
+    switch (action) {
+        case ACTION_LEFT:           move(game_data, LEFT); break;
+        case ACTION_RIGHT:          move(game_data, RIGHT); break;
+        case ACTION_ROTATE_RIGHT:   rotate_piece(game_data, RIGHT); break;
+        case ACTION_ROTATE_LEFT:    rotate_piece(game_data, LEFT); break;
+        case ACTION_SOFT_DROP:      drop(game_data); break;
+        case ACTION_HARD_DROP:      hard_drop(game_data); break;
+        default:                    break;
+    }
+    if (pieces_played(game_data) == pieces && !game_data->is_defeat) drop(game_data);
+
+    return pieces_played(game_data) != pieces;
+}
+
+/*
+    Helper function that compares game i of a batch with a game of the engine.
+*/
+static bool same_batch_game(const struct BatchGames* batch, int game, const struct GameData* game_data)
+{
+    return memcmp(batch->rows + (size_t)game * batch->height, game_data->arena_rows, sizeof(arena_row_t) * batch->height) == 0
+        && batch->score[game] == game_data->score && batch->cleared_lines[game] == game_data->cleared_lines
+        && batch->level[game] == game_data->level && batch->piece[game] == game_data->current_piece
+        && batch->rotation[game] == game_data->rotation
+        && batch->position_x[game] == game_data->position_x && batch->position_y[game] == game_data->position_y;
+}
+
+#define VERIFY_BATCH_GAMES 256
+#define VERIFY_BATCH_STEPS 2000
+
+int verify_batch(void)
+{
+    uint64_t steps = 0;
+    uint64_t defeats = 0;
+    uint64_t lines = 0;
+    int failures = 0;
+
+    for (size_t i = 0; i < VERIFY_CONFIG_COUNT; i++) {
+        struct GameConfig config = verify_config(i);
+        static struct GameData games[VERIFY_BATCH_GAMES];
+        bool playing[VERIFY_BATCH_GAMES];
+        uint8_t actions[VERIFY_BATCH_GAMES];
+        float rewards[VERIFY_BATCH_GAMES];
+        uint8_t dones[VERIFY_BATCH_GAMES];
+        struct BatchGames batch;
+        struct Rng rng;
+        uint32_t seed = 1000 * (uint32_t)(i + 1);
+
+        void* memory = aligned_alloc(CACHE_LINE_SIZE, batch_memory_size(VERIFY_BATCH_GAMES, &config));
+        if (!memory) return 1;
+
+        // game i of the batch plays its first episode with the seed of the batch plus i
+        init_batch(&batch, memory, VERIFY_BATCH_GAMES, seed, &config);
+        for (int game = 0; game < VERIFY_BATCH_GAMES; game++) {
+            games[game] = init_gamedata_with_config(seed + game, &config);
+            playing[game] = true;
+        }
+        rng_seed(&rng, seed);
+
+        for (int step = 0; step < VERIFY_BATCH_STEPS; step++) {
+            for (int game = 0; game < VERIFY_BATCH_GAMES; game++) actions[game] = (uint8_t)rng_range(&rng, ACTIONS);
+            batch_step(&batch, actions, rewards, dones);
+
+            for (int game = 0; game < VERIFY_BATCH_GAMES; game++) {
+                if (!playing[game]) continue;
+
+                uint32_t score = games[game].score;
+                play_action(&games[game], actions[game]);
+                steps++;
+
+                // a lost game of the batch starts over, only the defeat itself can be compared
+                bool same = rewards[game] == (float)(games[game].score - score) && dones[game] == games[game].is_defeat
+                         && (games[game].is_defeat || same_batch_game(&batch, game, &games[game]));
+                if (!same) {
+                    if (failures < 10) {
+                        printf("game %d of the batch differs in step %d (rules %s %dx%d)\n",
+                               game, step, games[game].rules.name, batch.width, batch.height);
+                    }
+                    failures++;
+                }
+                if (!same || games[game].is_defeat) {
+                    playing[game] = false;
+                    defeats += games[game].is_defeat;
+                    lines += games[game].cleared_lines;
+                }
+            }
+        }
+        free(memory);
+    }
+
+    printf("%s: %d of %" PRIu64 " batch steps differ from the engine, %" PRIu64 " games lost with %" PRIu64 " lines\n",
+           (failures == 0) ? "passed" : "FAILED", failures, steps, defeats, lines);
+    return failures;
+}
+
+/*
+    Helper function that compares an observation with the state of a game: the cells are taken from the color plane
+    and the blocks of the current piece, followed by the current piece and the preview.
+*/
+static bool same_observation(const uint8_t* observation, const struct GameData* game_data)
+{
+    static uint8_t expected[ARENA_MAX_WIDTH * ARENA_MAX_HEIGHT + 1 + PREVIEW_MAX_DEPTH];
+    int cells = game_data->width * game_data->height;
+
+    for (int i = 0; i < cells; i++) expected[i] = game_data->arena[i] != 0;
+
+    const struct PieceShape* shape = get_piece_shape(game_data->current_piece, game_data->rotation);
+    for (int i = 0; i < PIECE_BLOCKS; i++) {
+        int x = game_data->position_x + shape->cells[i][0];
+        int y = game_data->position_y + shape->cells[i][1];
+        if (y >= 0) expected[y * game_data->width + x] = 2;
+    }
+
+    expected[cells] = game_data->current_piece;
+    for (int i = 0; i < game_data->preview.depth; i++) expected[cells + 1 + i] = get_next_piece(game_data, i);
+
+    return memcmp(observation, expected, cells + 1 + game_data->preview.depth) == 0;
+}
+
+#define VERIFY_ENV_STEPS 3000
+
+int verify_env(void)
+{
+    static struct Env env;
+    static uint8_t observation[ARENA_MAX_WIDTH * ARENA_MAX_HEIGHT + 1 + PREVIEW_MAX_DEPTH];
+    uint64_t steps = 0;
+    uint64_t episodes = 0;
+    int failures = 0;
+
+    for (size_t i = 0; i < VERIFY_CONFIG_COUNT; i++) {
+        struct GameConfig config = verify_config(i);
+
+        for (uint32_t seed = 1; seed <= VERIFY_SEEDS; seed++) {
+            struct GameData game_data = init_gamedata_with_config(seed, &config);
+            struct Rng rng;
+            bool same = true;
+
+            env_create(&env, seed, &config);
+            rng_seed(&rng, seed);
+
+            for (int step = 0; step < VERIFY_ENV_STEPS && same; step++) {
+                int action = (int)rng_range(&rng, ACTIONS);
+                uint32_t score = game_data.score;
+                float reward;
+
+                bool done = env_step(&env, action, &reward);
+                play_action(&game_data, action);
+                steps++;
+
+                env_observe(&env, observation);
+                same = env_observation_size(&env) == (size_t)game_data.width * game_data.height + 1 + game_data.preview.depth
+                    && reward == (float)(game_data.score - score) && done == game_data.is_defeat
+                    && same_observation(observation, &game_data);
+
+                if (done && same) {
+                    // the episode is over until the next reset, which continues with the next seed
+                    same = env_step(&env, ACTION_HARD_DROP, &reward) && reward == 0.0f;
+                    env_reset(&env, 0);
+                    game_data = init_gamedata_with_config(env.seed, &config);
+                    episodes++;
+
+                    env_observe(&env, observation);
+                    same = same && env.seed == seed + env.episode && same_observation(observation, &game_data);
+                }
+            }
+            if (!same) {
+                if (failures < 10) printf("env seed %u differs from the engine (rules %s %dx%d)\n",
+                                          seed, game_data.rules.name, game_data.width, game_data.height);
+                failures++;
+            }
+        }
+    }
+
+    printf("%s: %d of %d envs differ from the engine in %" PRIu64 " steps and %" PRIu64 " episodes\n",
+           (failures == 0) ? "passed" : "FAILED", failures, (int)(VERIFY_CONFIG_COUNT * VERIFY_SEEDS), steps, episodes);
+    return failures;
+}
+
+/*
+    Helper function that unpacks the bits written by encode_board_bits into rows and compares them with the arena.
+*/
+static bool same_board_bits(const uint8_t* bits, const struct GameData* game_data)
+{
+    for (int y = 0; y < game_data->height; y++) {
+        arena_row_t row = 0;
+        for (int x = 0; x < game_data->width; x++) {
+            size_t cell = (size_t)y * game_data->width + x;
+            row |= (arena_row_t)((bits[cell / 8] >> (cell % 8)) & 1) << x;
+        }
+        if (row != game_data->arena_rows[y]) return false;
+    }
+    return true;
+}
+
+/*
+    Helper function that checks the encoders of a single game: the packed bits have to decode to the arena
+    and the board plane and column heights of the observation have to match the arena.
+*/
+static bool check_game_encoders(const struct GameData* game_data, uint8_t* bits, float* observation)
+{
+    int width = game_data->width;
+    int height = game_data->height;
+
+    if (encode_board_bits(game_data, bits) != board_bits_size(width, height) || !same_board_bits(bits, game_data)) return false;
+
+    encode_observation(game_data, observation);
+    const float* heights = observation + observation_size(width, height, game_data->preview.depth) - width;
+
+    for (int x = 0; x < width; x++) {
+        int column_height = 0;
+        for (int y = 0; y < height; y++) {
+            bool block = (game_data->arena_rows[y] >> x) & 1;
+            if (observation[y * width + x] != (block ? 1.0f : 0.0f)) return false;
+            if (block && column_height == 0) column_height = height - y;
+        }
+        if (heights[x] != (float)column_height) return false;
+    }
+    return true;
+}
+
+/*
+    The arenas of the observation check: the verify arenas and sizes whose rows don't fill whole bytes
+    or need more than 32 bits.
+*/
+static const struct {
+    int width;
+    int height;
+} OBSERVATION_ARENAS[] = {
+    { 5, 5 }, { 7, 5 }, { 40, 12 }, { ARENA_MAX_WIDTH, 6 },
+};
+
+#define VERIFY_OBSERVATION_GAMES 128
+#define VERIFY_OBSERVATION_STEPS 1000
+
+int verify_observations(void)
+{
+    size_t arena_count = VERIFY_CONFIG_COUNT + sizeof(OBSERVATION_ARENAS) / sizeof(OBSERVATION_ARENAS[0]);
+    static struct GameData games[VERIFY_OBSERVATION_GAMES];
+    static uint8_t bits[ARENA_MAX_WIDTH * ARENA_MAX_HEIGHT / 8];
+    static float observation[ARENA_MAX_WIDTH * ARENA_MAX_HEIGHT + PIECE_TYPES * (1 + PREVIEW_MAX_DEPTH) + ARENA_MAX_WIDTH];
+    uint64_t checks = 0;
+    int failures = 0;
+
+    for (size_t i = 0; i < arena_count; i++) {
+        struct GameConfig config = verify_config((i < VERIFY_CONFIG_COUNT) ? i : 1);
+        if (i >= VERIFY_CONFIG_COUNT) {
+            config.width = OBSERVATION_ARENAS[i - VERIFY_CONFIG_COUNT].width;
+            config.height = OBSERVATION_ARENAS[i - VERIFY_CONFIG_COUNT].height;
+        }
+
+        struct BatchGames batch;
+        uint8_t actions[VERIFY_OBSERVATION_GAMES];
+        float rewards[VERIFY_OBSERVATION_GAMES];
+        uint8_t dones[VERIFY_OBSERVATION_GAMES];
+        bool playing[VERIFY_OBSERVATION_GAMES];
+        struct Rng rng;
+        uint32_t seed = 2000 * (uint32_t)(i + 1);
+
+        void* memory = aligned_alloc(CACHE_LINE_SIZE, batch_memory_size(VERIFY_OBSERVATION_GAMES, &config));
+        if (!memory) return failures + 1;
+        init_batch(&batch, memory, VERIFY_OBSERVATION_GAMES, seed, &config);
+
+        size_t bits_size = board_bits_size(batch.width, batch.height);
+        size_t size = observation_size(batch.width, batch.height, config.preview_depth);
+        uint8_t* batch_bits = malloc(bits_size * VERIFY_OBSERVATION_GAMES);
+        float* batch_observations = malloc(sizeof(float) * size * VERIFY_OBSERVATION_GAMES);
+        if (!batch_bits || !batch_observations) {
+            free(batch_observations);
+            free(batch_bits);
+            free(memory);
+            return failures + 1;
+        }
+
+        for (int game = 0; game < VERIFY_OBSERVATION_GAMES; game++) {
+            games[game] = init_gamedata_with_config(seed + game, &config);
+            playing[game] = true;
+        }
+        rng_seed(&rng, seed);
+
+        // the games of the batch play the same games as the engine, see verify_batch
+        for (int step = 0; step < VERIFY_OBSERVATION_STEPS; step++) {
+            encode_batch_board_bits(&batch, batch_bits);
+            encode_batch_observations(&batch, batch_observations);
+
+            for (int game = 0; game < VERIFY_OBSERVATION_GAMES; game++) {
+                if (!playing[game]) continue;
+
+                bool same = check_game_encoders(&games[game], bits, observation)
+                         && memcmp(batch_bits + game * bits_size, bits, bits_size) == 0
+                         && memcmp(batch_observations + game * size, observation, sizeof(float) * size) == 0;
+                checks++;
+
+                if (!same) {
+                    if (failures < 10) printf("observation of game %d differs in step %d (%dx%d)\n",
+                                              game, step, batch.width, batch.height);
+                    failures++;
+                    playing[game] = false;
+                }
+            }
+
+            for (int game = 0; game < VERIFY_OBSERVATION_GAMES; game++) actions[game] = (uint8_t)rng_range(&rng, ACTIONS);
+            batch_step(&batch, actions, rewards, dones);
+            for (int game = 0; game < VERIFY_OBSERVATION_GAMES; game++) {
+                if (playing[game]) play_action(&games[game], actions[game]);
+                if (games[game].is_defeat) playing[game] = false;
+            }
+        }
+
+        free(batch_observations);
+        free(batch_bits);
+        free(memory);
+    }
+
+    printf("%s: %d of %" PRIu64 " observations wrong\n", (failures == 0) ? "passed" : "FAILED", failures, checks);
+    return failures;
+}
+
+/*
+    Helper function that fills a board with random blocks below a random height: every cell is filled with
+    a probability of 3/4, so there are full rows, holes and wells next to each other.
+*/
+static void random_board(arena_row_t* rows, int width, int height, struct Rng* rng)
+{
+    int top = (int)rng_range(rng, height + 1);
+
+    for (int y = 0; y < height; y++) {
+        arena_row_t row = 0;
+        if (y >= top) {
+            for (int x = 0; x < width; x++) row |= (arena_row_t)(rng_range(rng, 4) != 0) << x;
+        }
+        rows[y] = row;
+    }
+}
+
+/*
+    Helper function that rates a board from the features of extract_board_features.
+*/
+static float reference_score(const struct Evaluator* evaluator, const arena_row_t* rows, int width, int height,
+                             float landing_height, int eroded_cells)
+{
+    int features[EVAL_FEATURES];
+    extract_board_features(rows, width, height, features);
+
+    float score = 0.0f;
+    for (int i = EVAL_ROW_TRANSITIONS; i < EVAL_FEATURES; i++) score += evaluator->weights[i] * (float)features[i];
+    return score + evaluator->weights[EVAL_LANDING_HEIGHT] * landing_height + evaluator->weights[EVAL_ERODED_CELLS] * eroded_cells;
+}
+
+static const struct {
+    int width;
+    int height;
+} EVALUATOR_ARENAS[] = {
+    { ARENA_WIDTH, ARENA_HEIGHT }, { 4, 8 }, { 7, 5 }, { 40, 12 }, { ARENA_MAX_WIDTH, ARENA_MAX_HEIGHT },
+};
+
+// not a multiple of the 4 boards of the widest kernel, so every kernel also rates a remainder
+#define VERIFY_EVALUATOR_BOARDS 1003
+
+int verify_evaluator(void)
+{
+    static const char* const KERNEL_NAMES[] = { "scalar", "sse2", "avx2" };
+    static const int COUNTS[] = { VERIFY_EVALUATOR_BOARDS, 1, 2, 3, 5, 6, 7 };
+    static arena_row_t rows[VERIFY_EVALUATOR_BOARDS * ARENA_MAX_HEIGHT];
+    static float landing_heights[VERIFY_EVALUATOR_BOARDS];
+    static uint8_t eroded_cells[VERIFY_EVALUATOR_BOARDS];
+    static float scores[VERIFY_EVALUATOR_BOARDS + 1];        // one more to find writes past the boards
+    static float scalar_scores[VERIFY_EVALUATOR_BOARDS];
+    static float plain_scores[VERIFY_EVALUATOR_BOARDS];     // scalar scores of the boards without their placements
+
+    struct Evaluator evaluator;
+    struct Rng rng;
+    uint64_t checks = 0;
+    int kernels = 0;
+    int failures = 0;
+
+    // weights of every feature, so that none of them can be wrong unnoticed
+    float weights[EVAL_FEATURES];
+    for (int i = 0; i < EVAL_FEATURES; i++) weights[i] = (EL_TETRIS_WEIGHTS[i] != 0.0f) ? EL_TETRIS_WEIGHTS[i] : -0.5f * (float)i;
+    init_evaluator(&evaluator, weights);
+    rng_seed(&rng, 1);
+
+    for (size_t i = 0; i < sizeof(EVALUATOR_ARENAS) / sizeof(EVALUATOR_ARENAS[0]); i++) {
+        int width = EVALUATOR_ARENAS[i].width;
+        int height = EVALUATOR_ARENAS[i].height;
+
+        for (int board = 0; board < VERIFY_EVALUATOR_BOARDS; board++) {
+            random_board(rows + (size_t)board * height, width, height, &rng);
+            landing_heights[board] = (float)rng_range(&rng, 2 * height) * 0.5f;
+            eroded_cells[board] = (uint8_t)rng_range(&rng, 17);
+        }
+
+        for (size_t c = 0; c < sizeof(COUNTS) / sizeof(COUNTS[0]); c++) {
+            int count = COUNTS[c];
+
+            evaluator.kernel = EVAL_KERNEL_SCALAR;
+            evaluate_boards(&evaluator, rows, count, width, height, landing_heights, eroded_cells, scalar_scores);
+
+            for (int board = 0; board < count; board++) {
+                float expected = reference_score(&evaluator, rows + (size_t)board * height, width, height,
+                                                 landing_heights[board], eroded_cells[board]);
+                if (fabsf(scalar_scores[board] - expected) > 1e-3f * fmaxf(1.0f, fabsf(expected))) {
+                    if (failures < 10) printf("scalar score of board %d (%dx%d) is %f instead of %f\n",
+                                              board, width, height, scalar_scores[board], expected);
+                    failures++;
+                }
+            }
+
+            evaluate_boards(&evaluator, rows, count, width, height, NULL, NULL, plain_scores);
+
+            // the kernels share the weighting of the features, so their scores are exactly the same
+            for (int kernel = EVAL_KERNEL_SSE2; kernel <= EVAL_KERNEL_AVX2; kernel++) {
+                if (!eval_kernel_supported(kernel)) continue;
+
+                evaluator.kernel = kernel;
+                for (int placed = 0; placed < 2; placed++) {
+                    scores[count] = -1.0f;
+                    evaluate_boards(&evaluator, rows, count, width, height, placed ? landing_heights : NULL,
+                                    placed ? eroded_cells : NULL, scores);
+                    const float* expected = placed ? scalar_scores : plain_scores;
+
+                    if (scores[count] != -1.0f) {
+                        printf("%s kernel writes past %d boards\n", KERNEL_NAMES[kernel], count);
+                        failures++;
+                    }
+
+                    for (int board = 0; board < count; board++) {
+                        checks++;
+                        if (scores[board] == expected[board]) continue;
+
+                        if (failures < 10) printf("%s score of board %d of %d (%dx%d) is %f instead of %f\n",
+                                                  KERNEL_NAMES[kernel], board, count, width, height, scores[board], expected[board]);
+                        failures++;
+                    }
+                }
+                evaluator.kernel = EVAL_KERNEL_SCALAR;
+            }
+        }
+    }
+
+    for (int kernel = EVAL_KERNEL_SSE2; kernel <= EVAL_KERNEL_AVX2; kernel++) kernels += eval_kernel_supported(kernel);
+
+    printf("%s: %d of %" PRIu64 " scores of %d SIMD kernels differ from the scalar kernel\n",
+           (failures == 0) ? "passed" : "FAILED", failures, checks, kernels);
+    return failures;
+}